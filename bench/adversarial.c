@@ -0,0 +1,216 @@
+//
+//  adversarial.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// Worst-case cost of `protoh` on hostile or broken input. Every pattern is fed, in
+// 20-byte packets, to a context in the default mode and in bounded mode (see
+// `blemb_protoh_context_t.candidates`). Output is CSV: one row per pattern and mode.
+//
+// `ns_per_byte` is the average cost, `max_ns_per_call` the slowest single call.
+// `vs_random` divides `ns_per_byte` by the cost of random bytes in the same mode: in
+// bounded mode it stays within a small constant for every pattern, while the default
+// mode grows with the claimed message length. With a header check (`header_check` = 1)
+// fake headers are rejected before any payload is buffered, in every mode. Runs that
+// exceed the time limit stop early and are marked as `truncated`.
+//
+// Usage: blemb-adversarial-bench [--time-ms=N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/frame.h>
+#include <blemb/protow.h>
+#include <blemb/protoh.h>
+
+#include "bench.h"
+
+#define BENCH_ADVERSARIAL_STREAM_SIZE (256 * 1024)
+#define BENCH_ADVERSARIAL_PACKET_SIZE 20
+#define BENCH_ADVERSARIAL_BUFFER_SIZE (65535 + 5)
+#define BENCH_ADVERSARIAL_MAGIC 0xAB
+
+typedef enum {
+    BENCH_PATTERN_RANDOM,           // Uniform random bytes.
+    BENCH_PATTERN_MAGIC_FLOOD,      // Nothing but magic bytes: every byte starts a 43947-byte claim.
+    BENCH_PATTERN_FAKE_HEADERS,     // A magic byte claiming 65000 bytes every 16 bytes.
+    BENCH_PATTERN_CLEAN,            // Valid 256-byte messages, as a sanity check.
+    BENCH_PATTERN_COUNT
+} bench_pattern_t;
+
+static const char * bench_pattern_names[BENCH_PATTERN_COUNT] = { "random", "magic_flood", "fake_headers", "clean" };
+
+typedef struct {
+    const char * name;
+    blemb_uint32_t candidate_max_count;     // Zero: default mode.
+    blemb_uint32_t work_budget;             // Zero: `blemb_protoh_handle`.
+    blemb_frame_format_t format;
+} bench_mode_t;
+
+static blemb_byte_t bench_data[BENCH_ADVERSARIAL_STREAM_SIZE];
+static blemb_size_t bench_data_size;
+static uint64_t bench_delivered_messages;
+
+static void bench_record_writer(blemb_buffer_t packet) {
+    if (bench_data_size + packet.size > sizeof(bench_data)) return;
+    
+    memcpy(bench_data + bench_data_size, packet.data, packet.size);
+    bench_data_size += packet.size;
+}
+
+static void bench_handler(blemb_buffer_t message) {
+    bench_delivered_messages++;
+    bench_consume(message.size);
+}
+
+static void bench_generate(bench_pattern_t pattern, blemb_frame_format_t format) {
+    uint32_t seed = 0xBADC0DE ^ (uint32_t)pattern;
+    bench_data_size = 0;
+    
+    switch (pattern) {
+        case BENCH_PATTERN_MAGIC_FLOOD:
+            memset(bench_data, BENCH_ADVERSARIAL_MAGIC, sizeof(bench_data));
+            bench_data_size = sizeof(bench_data);
+            break;
+        case BENCH_PATTERN_FAKE_HEADERS:
+            for (blemb_size_t i = 0; i < sizeof(bench_data); i++) {
+                blemb_byte_t byte = (blemb_byte_t)bench_random(&seed);
+                if (byte == BENCH_ADVERSARIAL_MAGIC) byte = 0;
+                
+                switch (i % 16) {
+                    case 0: byte = BENCH_ADVERSARIAL_MAGIC; break;
+                    case 1: byte = 0xFD; break;
+                    case 2: byte = 0xE8; break;
+                }
+                bench_data[i] = byte;
+            }
+            bench_data_size = sizeof(bench_data);
+            break;
+        case BENCH_PATTERN_CLEAN: {
+            blemb_byte_t payload[256];
+            for (blemb_size_t i = 0; i < sizeof(payload); i++) {
+                payload[i] = (blemb_byte_t)bench_random(&seed);
+            }
+            
+            blemb_protow_context_t writer = { .magic = BENCH_ADVERSARIAL_MAGIC, .mtu = BENCH_ADVERSARIAL_PACKET_SIZE, .format = format, .writer = bench_record_writer };
+            blemb_buffer_t message = { .size = sizeof(payload), .data = payload };
+            while (bench_data_size + sizeof(payload) + 5 <= sizeof(bench_data)) {
+                blemb_protow_write(&writer, message);
+            }
+            break;
+        }
+        default:
+            for (blemb_size_t i = 0; i < sizeof(bench_data); i++) {
+                bench_data[i] = (blemb_byte_t)bench_random(&seed);
+            }
+            bench_data_size = sizeof(bench_data);
+            break;
+    }
+}
+
+static double bench_run(bench_mode_t * mode, bench_pattern_t pattern, uint64_t time_ns, double random_ns_per_byte) {
+    static blemb_byte_t buffer[BENCH_ADVERSARIAL_BUFFER_SIZE];
+    blemb_protoh_candidate_t candidates[64];
+    
+    blemb_protoh_context_t handler = {
+        .magic = BENCH_ADVERSARIAL_MAGIC,
+        .format = mode->format,
+        .buffer_data = buffer,
+        .buffer_max_size = sizeof(buffer),
+        .handler = bench_handler,
+        .candidates = mode->candidate_max_count > 0 ? candidates : NULL,
+        .candidate_max_count = mode->candidate_max_count,
+        .work_budget = mode->work_budget,
+    };
+    
+    bench_delivered_messages = 0;
+    uint64_t calls = 0;
+    uint64_t max_call_ns = 0;
+    uint64_t start_ns = bench_now_ns();
+    int truncated = 0;
+    
+    blemb_offset_t offset = 0;
+    while (offset < bench_data_size) {
+        blemb_size_t size = bench_data_size - offset;
+        if (size > BENCH_ADVERSARIAL_PACKET_SIZE) size = BENCH_ADVERSARIAL_PACKET_SIZE;
+        blemb_buffer_t packet = { .size = size, .data = bench_data + offset };
+        
+        // With a budget, the rest of the packet is handed over again in later calls.
+        while (packet.size > 0) {
+            blemb_size_t consumed = packet.size;
+            uint64_t call_start_ns = bench_now_ns();
+            if (mode->work_budget > 0) {
+                blemb_protoh_handle_partial(&handler, packet, &consumed);
+            } else {
+                blemb_protoh_handle(&handler, packet);
+            }
+            uint64_t call_ns = bench_now_ns() - call_start_ns;
+            
+            if (call_ns > max_call_ns) max_call_ns = call_ns;
+            calls++;
+            
+            packet.data += consumed;
+            packet.size -= consumed;
+        }
+        offset += size;
+        
+        if (bench_now_ns() - start_ns > time_ns) {
+            truncated = 1;
+            break;
+        }
+    }
+    uint64_t ns = bench_now_ns() - start_ns;
+    
+    double ns_per_byte = offset > 0 ? (double)ns / (double)offset : 0;
+    double vs_random = random_ns_per_byte > 0 ? ns_per_byte / random_ns_per_byte : 1;
+    printf("%s,%s,%u,%u,%d,%u,%llu,%.4f,%llu,%.2f,%llu,%d\n",
+           bench_pattern_names[pattern], mode->name, mode->candidate_max_count, mode->work_budget,
+           (mode->format & BLEMB_FRAME_FLAG_HEADER_CHECK) != 0,
+           offset, (unsigned long long)calls, ns_per_byte, (unsigned long long)max_call_ns, vs_random,
+           (unsigned long long)bench_delivered_messages, truncated);
+    
+    return ns_per_byte;
+}
+
+int main(int argc, char ** argv) {
+    uint64_t time_ms = 2000;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--time-ms=", 10) == 0) {
+            time_ms = strtoull(argv[i] + 10, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--time-ms=N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    bench_mode_t modes[] = {
+        { .name = "default" },
+        { .name = "bounded", .candidate_max_count = 4 },
+        { .name = "bounded", .candidate_max_count = 16 },
+        { .name = "bounded", .candidate_max_count = 16, .work_budget = 256 },
+        { .name = "default", .format = BLEMB_FRAME_FORMAT_V1 | BLEMB_FRAME_FLAG_HEADER_CHECK },
+        { .name = "bounded", .candidate_max_count = 4, .format = BLEMB_FRAME_FORMAT_V1 | BLEMB_FRAME_FLAG_HEADER_CHECK },
+    };
+    size_t mode_count = sizeof(modes) / sizeof(modes[0]);
+    double random_ns_per_byte[sizeof(modes) / sizeof(modes[0])] = { 0 };
+    
+    printf("pattern,mode,candidate_max_count,work_budget,header_check,bytes,calls,ns_per_byte,max_ns_per_call,vs_random,delivered,truncated\n");
+    
+    // Random bytes come first: they are the reference for `vs_random`.
+    for (int p = 0; p < BENCH_PATTERN_COUNT; p++) {
+        for (size_t m = 0; m < mode_count; m++) {
+            bench_generate((bench_pattern_t)p, modes[m].format);
+            double ns_per_byte = bench_run(&modes[m], (bench_pattern_t)p, time_ms * 1000000ULL, random_ns_per_byte[m]);
+            if (p == BENCH_PATTERN_RANDOM) random_ns_per_byte[m] = ns_per_byte;
+            fflush(stdout);
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
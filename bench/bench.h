@@ -0,0 +1,57 @@
+//
+//  bench.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_BENCH_H
+#define BLEMB_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Monotonic wall clock, in nanoseconds.
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Cycle counter, or 0 when the platform has none we can read from user space.
+// On AArch64 the virtual counter ticks at a fixed frequency, not at the core clock.
+static inline uint64_t bench_now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return 0;
+#endif
+}
+
+// Small deterministic generator, so every run benchmarks the same data.
+static inline uint32_t bench_random(uint32_t * state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    
+    return x;
+}
+
+// Keeps the optimizer from discarding benchmarked results.
+static inline void bench_consume(uint32_t value) {
+    static volatile uint32_t sink;
+    sink ^= value;
+}
+
+#endif
@@ -0,0 +1,199 @@
+//
+//  compress.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// Compression stage: ratio and CPU cost on typical payloads. Output is CSV.
+//
+// Each row compresses and decompresses a set of generated payloads (`corpus`: JSON
+// telemetry, log lines or random bytes) of `size` bytes, without and with a static
+// dictionary made of typical messages. `ratio` is compressed bytes per payload byte,
+// counting the encoding byte and the payloads sent raw because they did not shrink;
+// `raw_percent` is the share of those. Times are per payload byte, raw ones included;
+// `stream_ns_per_byte` decodes through a window of `BLEMB_LZ_WINDOW_SIZE` bytes, piece
+// by piece, as `protoh` does in streaming mode.
+//
+// Usage: blemb-compress-bench [--quick]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/lz.h>
+
+#include <blemb_lz.h>
+
+#include "bench.h"
+
+#define BENCH_COMPRESS_MESSAGE_COUNT 64
+#define BENCH_COMPRESS_MAX_SIZE 4096
+#define BENCH_COMPRESS_CHUNK_SIZE 20
+
+typedef enum {
+    BENCH_CORPUS_TELEMETRY,
+    BENCH_CORPUS_LOGS,
+    BENCH_CORPUS_RANDOM,
+} bench_corpus_t;
+
+static const char * bench_corpus_names[] = { "telemetry", "logs", "random" };
+
+static const char bench_dictionary[] =
+    "{\"device\":\"node-00\",\"seq\":0,\"temp\":21.50,\"hum\":40.0,\"batt\":3.71,\"rssi\":-60}"
+    "[INFO] sensor: sample ok\n[WARN] radio: retry on channel 37\n[ERROR] flash: write failed at 0x0800\n";
+
+static blemb_byte_t bench_messages[BENCH_COMPRESS_MESSAGE_COUNT][BENCH_COMPRESS_MAX_SIZE];
+
+static blemb_buffer_t bench_buffer(blemb_byte_t * data, blemb_size_t size) {
+    blemb_buffer_t buffer = { .size = size, .data = data };
+    return buffer;
+}
+
+static blemb_size_t bench_append(blemb_byte_t * target, blemb_size_t offset, blemb_size_t size, const char * text) {
+    // Appends `text`, cut at `size`, returns the new offset.
+    while (*text != '\0' && offset < size) {
+        target[offset++] = (blemb_byte_t)*text++;
+    }
+    return offset;
+}
+
+static void bench_generate(bench_corpus_t corpus, blemb_byte_t * target, blemb_size_t size, uint32_t * seed) {
+    static const char * levels[] = { "INFO", "INFO", "INFO", "WARN", "ERROR" };
+    static const char * events[] = { "sensor: sample ok", "radio: retry on channel 37", "flash: write failed at 0x0800", "power: entering sleep" };
+    
+    blemb_size_t offset = 0;
+    char text[128];
+    while (offset < size) {
+        if (corpus == BENCH_CORPUS_RANDOM) {
+            target[offset++] = (blemb_byte_t)bench_random(seed);
+            continue;
+        }
+        
+        uint32_t value = bench_random(seed);
+        if (corpus == BENCH_CORPUS_TELEMETRY) {
+            snprintf(text, sizeof(text), "{\"device\":\"node-%02u\",\"seq\":%u,\"temp\":%u.%02u,\"hum\":%u.%u,\"batt\":3.%02u,\"rssi\":-%u}",
+                     value % 16, value % 100000, 18 + value % 8, value % 100, 30 + value % 40, value % 10, 60 + value % 20, 40 + value % 50);
+        } else {
+            snprintf(text, sizeof(text), "[%s] %s\n", levels[value % 5], events[(value >> 8) % 4]);
+        }
+        offset = bench_append(target, offset, size, text);
+    }
+}
+
+static void bench_compress_run(bench_corpus_t corpus, blemb_size_t size, blemb_bool_t with_dictionary, uint32_t rounds) {
+    static blemb_byte_t compressed[BENCH_COMPRESS_MESSAGE_COUNT][BENCH_COMPRESS_MAX_SIZE];
+    static blemb_size_t compressed_sizes[BENCH_COMPRESS_MESSAGE_COUNT];
+    static blemb_byte_t output[BENCH_COMPRESS_MAX_SIZE];
+    static blemb_byte_t window[BLEMB_LZ_WINDOW_SIZE];
+    
+    blemb_buffer_t dictionary = with_dictionary == BLEMB_TRUE ? bench_buffer((blemb_byte_t *)bench_dictionary, sizeof(bench_dictionary) - 1) : bench_buffer(NULL, 0);
+    
+    uint32_t seed = 0xC0DE + (uint32_t)size;
+    for (blemb_size_t m = 0; m < BENCH_COMPRESS_MESSAGE_COUNT; m++) {
+        bench_generate(corpus, bench_messages[m], size, &seed);
+    }
+    
+    // Compression, as `protow` does it: only a gain is accepted.
+    uint64_t wire_bytes = 0;
+    uint32_t raw_count = 0;
+    uint64_t start_ns = bench_now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        wire_bytes = 0;
+        raw_count = 0;
+        for (blemb_size_t m = 0; m < BENCH_COMPRESS_MESSAGE_COUNT; m++) {
+            blemb_size_t compressed_size = 0;
+            blemb_buffer_t target = bench_buffer(compressed[m], size - 1);
+            if (blemb_lz_compress(dictionary, bench_buffer(bench_messages[m], size), target, &compressed_size) == BLEMB_FALSE) {
+                compressed_size = 0;
+                raw_count++;
+            }
+            compressed_sizes[m] = compressed_size;
+            wire_bytes += 1 + (compressed_size > 0 ? compressed_size : size);
+        }
+    }
+    uint64_t compress_ns = bench_now_ns() - start_ns;
+    
+    // Decompression into a buffer that holds the whole message.
+    start_ns = bench_now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (blemb_size_t m = 0; m < BENCH_COMPRESS_MESSAGE_COUNT; m++) {
+            if (compressed_sizes[m] == 0) continue;
+            
+            blemb_size_t output_size = 0;
+            blemb_lz_decompress(dictionary, bench_buffer(compressed[m], compressed_sizes[m]), bench_buffer(output, sizeof(output)), &output_size);
+            if (output_size != size || memcmp(output, bench_messages[m], size) != 0) {
+                fprintf(stderr, "%s message %u of %u bytes does not decompress\n", bench_corpus_names[corpus], (unsigned)m, (unsigned)size);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    uint64_t decompress_ns = bench_now_ns() - start_ns;
+    
+    // Decompression through the window, fed in pieces the size of a small packet.
+    start_ns = bench_now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (blemb_size_t m = 0; m < BENCH_COMPRESS_MESSAGE_COUNT; m++) {
+            if (compressed_sizes[m] == 0) continue;
+            
+            blemb_lz_decoder_t decoder;
+            blemb_lz_decoder_init(&decoder, dictionary, window, sizeof(window));
+            
+            blemb_size_t offset = 0;
+            blemb_size_t checked = 0;
+            for (;;) {
+                blemb_size_t size_left = compressed_sizes[m] - offset;
+                blemb_size_t piece = size_left < BENCH_COMPRESS_CHUNK_SIZE ? size_left : BENCH_COMPRESS_CHUNK_SIZE;
+                offset += blemb_lz_decode(&decoder, bench_buffer(compressed[m] + offset, piece));
+                
+                blemb_buffer_t first, second;
+                blemb_lz_decoder_take(&decoder, &first, &second);
+                checked += first.size + second.size;
+                
+                if (first.size == 0 && offset == compressed_sizes[m]) break;
+            }
+            bench_consume((uint32_t)checked);
+            
+            if (checked != size || blemb_lz_decoder_is_complete(&decoder) == BLEMB_FALSE) {
+                fprintf(stderr, "%s message %u of %u bytes does not stream\n", bench_corpus_names[corpus], (unsigned)m, (unsigned)size);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    uint64_t stream_ns = bench_now_ns() - start_ns;
+    
+    double payload_bytes = (double)rounds * BENCH_COMPRESS_MESSAGE_COUNT * size;
+    printf("%s,%u,%s,%.3f,%.1f,%.2f,%.2f,%.2f\n",
+           bench_corpus_names[corpus], (unsigned)size, with_dictionary == BLEMB_TRUE ? "yes" : "no",
+           (double)wire_bytes / ((double)BENCH_COMPRESS_MESSAGE_COUNT * size),
+           100.0 * raw_count / BENCH_COMPRESS_MESSAGE_COUNT,
+           compress_ns / payload_bytes, decompress_ns / payload_bytes, stream_ns / payload_bytes);
+    fflush(stdout);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t rounds = 200;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            rounds = 10;
+        } else {
+            fprintf(stderr, "Usage: %s [--quick]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    static const blemb_size_t sizes[] = { 64, 240, 1024, 4096 };
+    
+    printf("corpus,size,dictionary,ratio,raw_percent,compress_ns_per_byte,decompress_ns_per_byte,stream_ns_per_byte\n");
+    for (int corpus = BENCH_CORPUS_TELEMETRY; corpus <= BENCH_CORPUS_RANDOM; corpus++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            bench_compress_run((bench_corpus_t)corpus, sizes[s], BLEMB_FALSE, rounds);
+            bench_compress_run((bench_corpus_t)corpus, sizes[s], BLEMB_TRUE, rounds);
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
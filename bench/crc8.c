@@ -0,0 +1,84 @@
+//
+//  crc8.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// Compares the CRC8 kernel selected at compile time against the bitwise
+// reference implementation. Output is CSV: one row per kernel and size.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/crc8.h>
+
+#include <blemb_crc8.h>
+
+#include "bench.h"
+
+#define BENCH_CRC8_DATA_SIZE 65536
+#define BENCH_CRC8_TARGET_BYTES (256ULL * 1024 * 1024)
+
+static const char * bench_crc8_kernel_name(void) {
+    switch (BLEMB_CRC8_KERNEL) {
+        case BLEMB_CRC8_KERNEL_TABLE: return "table";
+        case BLEMB_CRC8_KERNEL_SLICING4: return "slicing4";
+        case BLEMB_CRC8_KERNEL_SLICING8: return "slicing8";
+        default: return "bitwise";
+    }
+}
+
+static void bench_crc8_run(const char * name, blemb_byte_t (*update)(blemb_byte_t, blemb_buffer_t), blemb_byte_t * data, blemb_size_t size) {
+    // Bitwise is roughly an order of magnitude slower, so it gets less data.
+    uint64_t target = update == blemb_crc8_update_bitwise ? BENCH_CRC8_TARGET_BYTES / 16 : BENCH_CRC8_TARGET_BYTES;
+    uint64_t iterations = target / size;
+    if (iterations < 1) iterations = 1;
+    
+    blemb_buffer_t buffer = { .size = size, .data = data };
+    blemb_byte_t crc = 0;
+    
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cycles = bench_now_cycles();
+    for (uint64_t i = 0; i < iterations; i++) {
+        crc = update(crc, buffer);
+    }
+    uint64_t cycles = bench_now_cycles() - start_cycles;
+    uint64_t ns = bench_now_ns() - start_ns;
+    bench_consume(crc);
+    
+    double bytes = (double)iterations * size;
+    printf("%s,%u,%.1f,%.3f,%.3f\n", name, size, bytes / ((double)ns / 1e9) / 1e6, (double)ns / bytes, (double)cycles / bytes);
+}
+
+int main(void) {
+    static blemb_byte_t data[BENCH_CRC8_DATA_SIZE];
+    uint32_t seed = 0x12345678;
+    for (blemb_size_t i = 0; i < BENCH_CRC8_DATA_SIZE; i++) {
+        data[i] = (blemb_byte_t)bench_random(&seed);
+    }
+    
+    // Make sure the selected kernel matches the reference before timing it,
+    // including unaligned starts and sizes that are not a multiple of the block size.
+    for (blemb_size_t offset = 0; offset < 16; offset++) {
+        for (blemb_size_t size = 0; size < 300; size++) {
+            blemb_buffer_t buffer = { .size = size, .data = data + offset };
+            if (blemb_crc8_update(0x5A, buffer) != blemb_crc8_update_bitwise(0x5A, buffer)) {
+                fprintf(stderr, "crc8 kernel %s does not match the bitwise reference (offset %u, size %u)\n", bench_crc8_kernel_name(), offset, size);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    
+    static const blemb_size_t sizes[] = { 4, 20, 64, 247, 1024, 4096, 65536 };
+    
+    printf("kernel,size,mb_per_s,ns_per_byte,cycles_per_byte\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_crc8_run("bitwise", blemb_crc8_update_bitwise, data, sizes[i]);
+        bench_crc8_run(bench_crc8_kernel_name(), blemb_crc8_update, data, sizes[i]);
+    }
+    
+    return EXIT_SUCCESS;
+}
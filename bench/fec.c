@@ -0,0 +1,263 @@
+//
+//  fec.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// Forward error correction in reliable mode: CPU cost against goodput. Output is CSV,
+// in two tables.
+//
+// `kernel` rows time the GF(256) kernel selected at compile time, and the bitwise
+// reference, on fragment-sized buffers.
+//
+// `link` rows send 4 KB messages in reliable mode over a simulated link (MTU 244) that
+// loses packets at random, for several parity setups (`data_count` data fragments for
+// every `parity_count` parity fragments, zero: no parity) and loss rates. The receiver
+// reports after every burst; reports are never lost. `encode_ns_per_byte` and
+// `decode_ns_per_byte` are the CPU time spent in `protow` and `protoh` per payload byte,
+// parity and retransmissions included. `wire_per_payload` counts link bytes per payload
+// byte, `round_trips_per_msg` the reports that had to ask for fragments again.
+// `goodput_kbps` puts both together on a link of `--link-kbps` where each round trip
+// costs `--rtt-ms` (one connection interval, by default).
+//
+// Usage: blemb-fec-bench [--quick] [--link-kbps=N] [--rtt-ms=N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/frame.h>
+#include <blemb/protow.h>
+#include <blemb/protoh.h>
+
+#include <blemb_gf256.h>
+
+#include "bench.h"
+
+#define BENCH_FEC_MTU 244
+#define BENCH_FEC_MESSAGE_SIZE 4096
+#define BENCH_FEC_KERNEL_TARGET_BYTES (64ULL * 1024 * 1024)
+#define BENCH_FEC_LINK_CAPACITY (256 * 1024)
+
+typedef struct {
+    blemb_uint8_t data_count;
+    blemb_uint8_t parity_count;
+} bench_fec_setup_t;
+
+// Packets that made it through the simulated link, waiting to be received.
+static blemb_byte_t bench_link_data[BENCH_FEC_LINK_CAPACITY];
+static blemb_size_t bench_link_sizes[BENCH_FEC_LINK_CAPACITY / 8];
+static blemb_size_t bench_link_size;
+static blemb_size_t bench_link_count;
+static uint64_t bench_link_wire_bytes;
+static uint32_t bench_link_loss_per_million;
+static uint32_t bench_link_seed;
+static uint64_t bench_delivered_messages;
+
+static const char * bench_fec_kernel_name(void) {
+    return BLEMB_GF256_KERNEL == BLEMB_GF256_KERNEL_TABLE ? "table" : "nibble";
+}
+
+static void bench_link_writer(blemb_buffer_t packet) {
+    bench_link_wire_bytes += packet.size;
+    if (bench_random(&bench_link_seed) % 1000000 < bench_link_loss_per_million) return;
+    if (bench_link_size + packet.size > sizeof(bench_link_data)) return;
+    
+    memcpy(bench_link_data + bench_link_size, packet.data, packet.size);
+    bench_link_size += packet.size;
+    bench_link_sizes[bench_link_count++] = packet.size;
+}
+
+static void bench_handler(blemb_buffer_t message) {
+    bench_delivered_messages++;
+    bench_consume(message.size);
+}
+
+static void bench_fec_kernel_run(const char * name, void (*mul_add)(blemb_byte_t *, const blemb_byte_t *, blemb_byte_t, blemb_size_t), blemb_byte_t * target, blemb_byte_t * source, blemb_size_t size) {
+    // Bitwise is much slower, so it gets less data.
+    uint64_t bytes_target = mul_add == blemb_gf256_mul_add_bitwise ? BENCH_FEC_KERNEL_TARGET_BYTES / 64 : BENCH_FEC_KERNEL_TARGET_BYTES;
+    uint64_t iterations = bytes_target / size;
+    if (iterations < 1) iterations = 1;
+    
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cycles = bench_now_cycles();
+    for (uint64_t i = 0; i < iterations; i++) {
+        // Any coefficient but 0 and 1, which are shortcuts.
+        mul_add(target, source, (blemb_byte_t)(2 + i % 254), size);
+    }
+    uint64_t cycles = bench_now_cycles() - start_cycles;
+    uint64_t ns = bench_now_ns() - start_ns;
+    bench_consume(target[0]);
+    
+    double bytes = (double)iterations * size;
+    printf("%s,%u,%.1f,%.3f,%.3f\n", name, size, bytes / ((double)ns / 1e9) / 1e6, (double)ns / bytes, (double)cycles / bytes);
+}
+
+static int bench_fec_kernels(void) {
+    static blemb_byte_t source[4096];
+    static blemb_byte_t target[4096];
+    static blemb_byte_t reference[4096];
+    uint32_t seed = 0x12345678;
+    for (blemb_size_t i = 0; i < sizeof(source); i++) {
+        source[i] = (blemb_byte_t)bench_random(&seed);
+        target[i] = reference[i] = (blemb_byte_t)bench_random(&seed);
+    }
+    
+    // Make sure the selected kernel matches the reference before timing it, including
+    // sizes that are not a multiple of the vector width.
+    for (blemb_size_t coefficient = 0; coefficient < 256; coefficient++) {
+        blemb_size_t size = 200 + coefficient % 37;
+        blemb_gf256_mul_add(target, source, (blemb_byte_t)coefficient, size);
+        blemb_gf256_mul_add_bitwise(reference, source, (blemb_byte_t)coefficient, size);
+        if (memcmp(target, reference, sizeof(target)) != 0) {
+            fprintf(stderr, "gf256 kernel %s does not match the bitwise reference (coefficient %u)\n", bench_fec_kernel_name(), coefficient);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    static const blemb_size_t sizes[] = { 16, 240, 4092 };
+    
+    printf("kernel,size,mb_per_s,ns_per_byte,cycles_per_byte\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_fec_kernel_run("bitwise", blemb_gf256_mul_add_bitwise, target, source, sizes[i]);
+        bench_fec_kernel_run(bench_fec_kernel_name(), blemb_gf256_mul_add, target, source, sizes[i]);
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+static uint64_t bench_link_receive(blemb_protoh_context_t * handler) {
+    // Feeds the packets that got through, returns the time it took.
+    uint64_t start_ns = bench_now_ns();
+    
+    blemb_offset_t offset = 0;
+    for (blemb_size_t i = 0; i < bench_link_count; i++) {
+        blemb_buffer_t packet = { .size = bench_link_sizes[i], .data = bench_link_data + offset };
+        blemb_protoh_handle_reliable(handler, packet);
+        offset += bench_link_sizes[i];
+    }
+    
+    bench_link_size = 0;
+    bench_link_count = 0;
+    return bench_now_ns() - start_ns;
+}
+
+static void bench_fec_link_run(bench_fec_setup_t setup, uint32_t loss_per_million, uint32_t message_count, double link_kbps, double rtt_ms) {
+    static blemb_byte_t payload[BENCH_FEC_MESSAGE_SIZE];
+    static blemb_byte_t buffer[BENCH_FEC_MESSAGE_SIZE + 16];
+    static blemb_byte_t fragment_map[BENCH_FEC_MESSAGE_SIZE / 16 / 8 + 1];
+    static blemb_byte_t fec_buffer[4 * (4 + BLEMB_FRAME_FEC_MAX_PARITY_COUNT * BENCH_FEC_MTU)];
+    
+    uint32_t seed = 0xFEC0 + loss_per_million;
+    for (blemb_size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (blemb_byte_t)bench_random(&seed);
+    }
+    
+    blemb_protow_context_t writer = {
+        .magic = 0xAB,
+        .mtu = BENCH_FEC_MTU,
+        .writer = bench_link_writer,
+        .fec_data_count = setup.data_count,
+        .fec_parity_count = setup.parity_count,
+    };
+    blemb_protoh_context_t handler = {
+        .magic = 0xAB,
+        .buffer_data = buffer,
+        .buffer_max_size = sizeof(buffer),
+        .handler = bench_handler,
+        .fragment_map = fragment_map,
+        .fragment_map_size = sizeof(fragment_map),
+        .fec_data_count = setup.data_count,
+        .fec_parity_count = setup.parity_count,
+        .fec_buffer = fec_buffer,
+        .fec_buffer_size = sizeof(fec_buffer),
+    };
+    
+    bench_link_seed = 0xBADC0DE ^ loss_per_million;
+    bench_link_loss_per_million = loss_per_million;
+    bench_link_wire_bytes = 0;
+    bench_delivered_messages = 0;
+    
+    uint64_t encode_ns = 0;
+    uint64_t decode_ns = 0;
+    uint64_t round_trips = 0;
+    blemb_buffer_t message = { .size = sizeof(payload), .data = payload };
+    
+    for (uint32_t m = 0; m < message_count; m++) {
+        uint64_t start_ns = bench_now_ns();
+        blemb_protow_write_reliable(&writer, message, NULL);
+        encode_ns += bench_now_ns() - start_ns;
+        decode_ns += bench_link_receive(&handler);
+        
+        while (writer.reliable_pending == BLEMB_TRUE) {
+            blemb_byte_t report_data[64];
+            blemb_buffer_t report = { .size = sizeof(report_data), .data = report_data };
+            blemb_size_t report_size = 0;
+            
+            start_ns = bench_now_ns();
+            blemb_bool_t has_report = blemb_protoh_reliable_report(&handler, report, &report_size);
+            decode_ns += bench_now_ns() - start_ns;
+            
+            // Anything but the acknowledgement of the pending message costs a round trip.
+            // Nothing got through: the sender's timer resends everything.
+            if (report_size != 1 || report_data[0] != writer.reliable_sequence) round_trips++;
+            
+            report.size = report_size;
+            start_ns = bench_now_ns();
+            if (has_report == BLEMB_TRUE) {
+                blemb_protow_handle_report(&writer, report);
+            } else {
+                blemb_protow_resend_reliable(&writer);
+            }
+            encode_ns += bench_now_ns() - start_ns;
+            decode_ns += bench_link_receive(&handler);
+        }
+    }
+    
+    double payload_bytes = (double)message_count * sizeof(payload);
+    double airtime_s = (double)bench_link_wire_bytes * 8 / (link_kbps * 1000) + (double)round_trips * rtt_ms / 1000;
+    
+    printf("%u,%u,%.2f,%.3f,%.3f,%.3f,%.3f,%.1f,%llu\n",
+           setup.data_count, setup.parity_count, loss_per_million / 10000.0,
+           encode_ns / payload_bytes, decode_ns / payload_bytes,
+           bench_link_wire_bytes / payload_bytes, (double)round_trips / message_count,
+           payload_bytes * 8 / 1000 / airtime_s, (unsigned long long)bench_delivered_messages);
+    fflush(stdout);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t message_count = 2000;
+    double link_kbps = 1000;
+    double rtt_ms = 30;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            message_count = 200;
+        } else if (strncmp(argv[i], "--link-kbps=", 12) == 0) {
+            link_kbps = strtod(argv[i] + 12, NULL);
+        } else if (strncmp(argv[i], "--rtt-ms=", 9) == 0) {
+            rtt_ms = strtod(argv[i] + 9, NULL);
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--link-kbps=N] [--rtt-ms=N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    if (bench_fec_kernels() != EXIT_SUCCESS) return EXIT_FAILURE;
+    printf("\n");
+    
+    static const bench_fec_setup_t setups[] = { { 0, 0 }, { 8, 1 }, { 8, 2 }, { 16, 4 } };
+    static const uint32_t losses_per_million[] = { 0, 10000, 50000, 100000, 200000 };
+    
+    printf("data_count,parity_count,loss_percent,encode_ns_per_byte,decode_ns_per_byte,wire_per_payload,round_trips_per_msg,goodput_kbps,delivered\n");
+    for (size_t l = 0; l < sizeof(losses_per_million) / sizeof(losses_per_million[0]); l++) {
+        for (size_t s = 0; s < sizeof(setups) / sizeof(setups[0]); s++) {
+            bench_fec_link_run(setups[s], losses_per_million[l], message_count, link_kbps, rtt_ms);
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
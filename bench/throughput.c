@@ -0,0 +1,333 @@
+//
+//  throughput.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// End-to-end throughput of `protow` and `protoh` over a matrix of MTUs, payload
+// sizes and link corruption. Every case writes messages with `blemb_protow_write`,
+// optionally corrupts the resulting packet stream, and feeds it, packet by packet,
+// to `blemb_protoh_handle`. Output is CSV (default) or JSON lines, one row per
+// case and component, so runs can be diffed across engine changes.
+//
+// `mb_per_s` is payload goodput. `wire_mb_per_s`, `ns_per_byte` and `cycles_per_byte`
+// count message bytes on the link (payload plus the 4 bytes of framing), so empty
+// payloads still get meaningful figures. `packets_per_msg` is the number of link
+// packets each message costs.
+//
+// On a clean link, messages smaller than a packet are also run with batching
+// (`protow_batch` and `protoh_batch` rows): several of them share each packet.
+//
+// Usage: blemb-bench [--json] [--quick] [--time-ms=N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/protow.h>
+#include <blemb/protoh.h>
+
+#include "bench.h"
+
+// Each case encodes enough messages to produce, at least, this many stream bytes.
+#define BENCH_STREAM_MIN_BYTES (1024 * 1024)
+#define BENCH_STREAM_MIN_MESSAGES 16
+
+typedef struct {
+    blemb_uint16_t mtu;
+    blemb_size_t payload_size;
+    double bit_error_rate;      // Probability of flipping each bit of the stream.
+    double garbage_rate;        // Probability of inserting a garbage packet before each packet.
+} bench_case_t;
+
+typedef struct {
+    blemb_byte_t * data;
+    blemb_size_t size;
+    blemb_size_t capacity;
+    
+    blemb_size_t * packet_sizes;
+    blemb_size_t packet_count;
+    blemb_size_t packet_capacity;
+} bench_stream_t;
+
+static bench_stream_t bench_stream;
+static uint64_t bench_delivered_messages;
+static uint64_t bench_written_packets;
+
+static void bench_stream_append(const blemb_byte_t * data, blemb_size_t size) {
+    if (bench_stream.size + size > bench_stream.capacity) {
+        bench_stream.capacity = (bench_stream.size + size) * 2;
+        bench_stream.data = realloc(bench_stream.data, bench_stream.capacity);
+    }
+    if (bench_stream.packet_count == bench_stream.packet_capacity) {
+        bench_stream.packet_capacity = bench_stream.packet_capacity * 2 + 64;
+        bench_stream.packet_sizes = realloc(bench_stream.packet_sizes, bench_stream.packet_capacity * sizeof(blemb_size_t));
+    }
+    
+    memcpy(bench_stream.data + bench_stream.size, data, size);
+    bench_stream.size += size;
+    bench_stream.packet_sizes[bench_stream.packet_count++] = size;
+}
+
+static void bench_record_writer(blemb_buffer_t packet) {
+    bench_stream_append(packet.data, packet.size);
+}
+
+static void bench_null_writer(blemb_buffer_t packet) {
+    bench_written_packets++;
+    bench_consume(packet.size);
+}
+
+static void bench_handler(blemb_buffer_t message) {
+    bench_delivered_messages++;
+    bench_consume(message.size);
+}
+
+static void bench_corrupt(bench_stream_t * clean, bench_case_t * c, uint32_t * seed) {
+    // Rebuild the stream packet by packet, flipping bits and inserting garbage packets.
+    bench_stream.size = 0;
+    bench_stream.packet_count = 0;
+    
+    blemb_byte_t garbage[4096];
+    blemb_offset_t offset = 0;
+    for (blemb_size_t i = 0; i < clean->packet_count; i++) {
+        if (c->garbage_rate > 0 && bench_random(seed) < c->garbage_rate * UINT32_MAX) {
+            blemb_size_t size = 1 + bench_random(seed) % c->mtu;
+            for (blemb_size_t j = 0; j < size; j++) {
+                garbage[j] = (blemb_byte_t)bench_random(seed);
+            }
+            bench_stream_append(garbage, size);
+        }
+        
+        blemb_offset_t start = bench_stream.size;
+        bench_stream_append(clean->data + offset, clean->packet_sizes[i]);
+        offset += clean->packet_sizes[i];
+        
+        if (c->bit_error_rate > 0) {
+            for (blemb_offset_t j = start; j < bench_stream.size; j++) {
+                for (blemb_uint32_t bit = 0; bit < 8; bit++) {
+                    if (bench_random(seed) < c->bit_error_rate * UINT32_MAX) {
+                        bench_stream.data[j] ^= (blemb_byte_t)(1u << bit);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void bench_report(const char * component, bench_case_t * c, uint64_t messages, uint64_t delivered, uint64_t ns, uint64_t cycles, double packets_per_msg, int json) {
+    double seconds = (double)ns / 1e9;
+    double payload_bytes = (double)messages * c->payload_size;
+    double wire_bytes = (double)messages * (c->payload_size + 4);
+    
+    double mb_per_s = payload_bytes / seconds / 1e6;
+    double wire_mb_per_s = wire_bytes / seconds / 1e6;
+    double msgs_per_s = (double)messages / seconds;
+    double ns_per_byte = (double)ns / wire_bytes;
+    double cycles_per_byte = (double)cycles / wire_bytes;
+    double delivery_ratio = messages > 0 ? (double)delivered / (double)messages : 0;
+    
+    if (json) {
+        printf("{\"component\":\"%s\",\"mtu\":%u,\"payload_size\":%u,\"bit_error_rate\":%g,\"garbage_rate\":%g,"
+               "\"mb_per_s\":%.3f,\"wire_mb_per_s\":%.3f,\"msgs_per_s\":%.1f,\"ns_per_byte\":%.4f,\"cycles_per_byte\":%.4f,\"delivery_ratio\":%.4f,"
+               "\"packets_per_msg\":%.4f}\n",
+               component, c->mtu, c->payload_size, c->bit_error_rate, c->garbage_rate,
+               mb_per_s, wire_mb_per_s, msgs_per_s, ns_per_byte, cycles_per_byte, delivery_ratio, packets_per_msg);
+    } else {
+        printf("%s,%u,%u,%g,%g,%.3f,%.3f,%.1f,%.4f,%.4f,%.4f,%.4f\n",
+               component, c->mtu, c->payload_size, c->bit_error_rate, c->garbage_rate,
+               mb_per_s, wire_mb_per_s, msgs_per_s, ns_per_byte, cycles_per_byte, delivery_ratio, packets_per_msg);
+    }
+}
+
+static void bench_run_batched(bench_case_t * c, blemb_buffer_t message, blemb_size_t message_count, blemb_protoh_context_t * handler, uint64_t time_ns, int json) {
+    // Same messages, packed back to back into full packets. The stream is flushed once per round.
+    blemb_byte_t * batch = malloc(c->mtu);
+    blemb_protow_context_t writer = { .magic = 0xAB, .mtu = c->mtu, .writer = bench_record_writer, .batch_data = batch };
+    
+    bench_stream_t plain = bench_stream;
+    bench_stream = (bench_stream_t){ 0 };
+    for (blemb_size_t i = 0; i < message_count; i++) {
+        blemb_protow_write(&writer, message);
+    }
+    blemb_protow_flush(&writer);
+    
+    writer.writer = bench_null_writer;
+    bench_written_packets = 0;
+    uint64_t messages = 0;
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cycles = bench_now_cycles();
+    uint64_t ns = 0;
+    do {
+        for (blemb_size_t i = 0; i < message_count; i++) {
+            blemb_protow_write(&writer, message);
+        }
+        blemb_protow_flush(&writer);
+        messages += message_count;
+        ns = bench_now_ns() - start_ns;
+    } while (ns < time_ns);
+    uint64_t cycles = bench_now_cycles() - start_cycles;
+    bench_report("protow_batch", c, messages, messages, ns, cycles, (double)bench_written_packets / messages, json);
+    
+    messages = 0;
+    bench_delivered_messages = 0;
+    start_ns = bench_now_ns();
+    start_cycles = bench_now_cycles();
+    do {
+        blemb_offset_t offset = 0;
+        for (blemb_size_t i = 0; i < bench_stream.packet_count; i++) {
+            blemb_buffer_t packet = { .size = bench_stream.packet_sizes[i], .data = bench_stream.data + offset };
+            blemb_protoh_handle(handler, packet);
+            offset += packet.size;
+        }
+        messages += message_count;
+        ns = bench_now_ns() - start_ns;
+    } while (ns < time_ns);
+    cycles = bench_now_cycles() - start_cycles;
+    bench_report("protoh_batch", c, messages, bench_delivered_messages, ns, cycles, (double)bench_stream.packet_count / message_count, json);
+    
+    free(bench_stream.data);
+    free(bench_stream.packet_sizes);
+    bench_stream = plain;
+    free(batch);
+}
+
+static void bench_run_case(bench_case_t * c, uint64_t time_ns, int json) {
+    uint32_t seed = 0xC0FFEE ^ c->mtu ^ (c->payload_size << 8);
+    
+    blemb_byte_t * payload = malloc(c->payload_size > 0 ? c->payload_size : 1);
+    for (blemb_size_t i = 0; i < c->payload_size; i++) {
+        payload[i] = (blemb_byte_t)bench_random(&seed);
+    }
+    blemb_buffer_t message = { .size = c->payload_size, .data = payload };
+    
+    // Encode the reference stream.
+    blemb_size_t message_count = BENCH_STREAM_MIN_BYTES / (c->payload_size + 4) + 1;
+    if (message_count < BENCH_STREAM_MIN_MESSAGES) message_count = BENCH_STREAM_MIN_MESSAGES;
+    
+    blemb_protow_context_t writer = { .magic = 0xAB, .mtu = c->mtu, .writer = bench_record_writer };
+    bench_stream.size = 0;
+    bench_stream.packet_count = 0;
+    for (blemb_size_t i = 0; i < message_count; i++) {
+        blemb_protow_write(&writer, message);
+    }
+    
+    // protow: encoding only, packets are discarded.
+    writer.writer = bench_null_writer;
+    bench_written_packets = 0;
+    uint64_t messages = 0;
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cycles = bench_now_cycles();
+    uint64_t ns = 0;
+    do {
+        for (blemb_size_t i = 0; i < message_count; i++) {
+            blemb_protow_write(&writer, message);
+        }
+        messages += message_count;
+        ns = bench_now_ns() - start_ns;
+    } while (ns < time_ns);
+    uint64_t cycles = bench_now_cycles() - start_cycles;
+    bench_report("protow", c, messages, messages, ns, cycles, (double)bench_written_packets / messages, json);
+    
+    // Corrupt a copy of the stream, keeping the clean one for reference.
+    bench_stream_t clean = bench_stream;
+    bench_stream = (bench_stream_t){ 0 };
+    bench_corrupt(&clean, c, &seed);
+    
+    // protoh: reassembly of the (possibly corrupted) stream.
+    blemb_size_t buffer_size = c->payload_size + 4;
+    blemb_byte_t * buffer = malloc(buffer_size);
+    blemb_protoh_context_t handler = {
+        .magic = 0xAB,
+        .buffer_data = buffer,
+        .buffer_max_size = buffer_size,
+        .handler = bench_handler,
+    };
+    
+    messages = 0;
+    bench_delivered_messages = 0;
+    start_ns = bench_now_ns();
+    start_cycles = bench_now_cycles();
+    do {
+        blemb_offset_t offset = 0;
+        for (blemb_size_t i = 0; i < bench_stream.packet_count; i++) {
+            blemb_buffer_t packet = { .size = bench_stream.packet_sizes[i], .data = bench_stream.data + offset };
+            blemb_protoh_handle(&handler, packet);
+            offset += packet.size;
+        }
+        messages += message_count;
+        ns = bench_now_ns() - start_ns;
+    } while (ns < time_ns);
+    cycles = bench_now_cycles() - start_cycles;
+    bench_report("protoh", c, messages, bench_delivered_messages, ns, cycles, (double)bench_stream.packet_count / message_count, json);
+    
+    free(bench_stream.data);
+    free(bench_stream.packet_sizes);
+    bench_stream = clean;
+    
+    if (c->bit_error_rate == 0 && c->garbage_rate == 0 && c->payload_size + 4 < c->mtu) {
+        bench_run_batched(c, message, message_count, &handler, time_ns, json);
+    }
+    
+    free(buffer);
+    free(payload);
+}
+
+int main(int argc, char ** argv) {
+    int json = 0;
+    int quick = 0;
+    uint64_t time_ms = 200;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else if (strncmp(argv[i], "--time-ms=", 10) == 0) {
+            time_ms = strtoull(argv[i] + 10, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--json] [--quick] [--time-ms=N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    static const blemb_uint16_t mtus[] = { 20, 64, 247, 512, 4096 };
+    static const blemb_size_t payload_sizes[] = { 0, 16, 256, 4096, 65535 };
+    static const double corruption[][2] = {
+        { 0, 0 },           // Clean link
+        { 1e-5, 0 },        // Bit errors
+        { 0, 0.1 },         // Garbage packets
+    };
+    
+    size_t mtu_count = quick ? 2 : sizeof(mtus) / sizeof(mtus[0]);
+    size_t size_count = sizeof(payload_sizes) / sizeof(payload_sizes[0]);
+    size_t corruption_count = quick ? 1 : sizeof(corruption) / sizeof(corruption[0]);
+    if (quick) time_ms = time_ms < 50 ? time_ms : 50;
+    
+    if (json == 0) {
+        printf("component,mtu,payload_size,bit_error_rate,garbage_rate,mb_per_s,wire_mb_per_s,msgs_per_s,ns_per_byte,cycles_per_byte,delivery_ratio,packets_per_msg\n");
+    }
+    
+    for (size_t m = 0; m < mtu_count; m++) {
+        for (size_t s = 0; s < size_count; s++) {
+            for (size_t k = 0; k < corruption_count; k++) {
+                bench_case_t c = {
+                    .mtu = mtus[quick ? m * 2 : m],
+                    .payload_size = payload_sizes[s],
+                    .bit_error_rate = corruption[k][0],
+                    .garbage_rate = corruption[k][1],
+                };
+                bench_run_case(&c, time_ms * 1000000ULL, json);
+                fflush(stdout);
+            }
+        }
+    }
+    
+    free(bench_stream.data);
+    free(bench_stream.packet_sizes);
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+# Generates the single-header build of the library: `blemb.h`.
+#
+# Public headers come first. Private headers and sources follow, guarded by
+# `BLEMB_IMPLEMENTATION`: define it in exactly one translation unit before
+# including `blemb.h`. `#include`s of library headers are dropped, their
+# contents are already part of the file.
+#
+# Usage: cmake -DBLEMB_SOURCE_DIR=<repo> -DBLEMB_OUTPUT=<blemb.h> -P amalgamate.cmake
+
+set(BLEMB_PUBLIC_HEADERS
+    include/blemb/types.h
+    include/blemb/buffer.h
+    include/blemb/crc8.h
+    include/blemb/frame.h
+    include/blemb/lz.h
+    include/blemb/pool.h
+    include/blemb/protow.h
+    include/blemb/protoh.h
+    include/blemb/protod.h
+)
+
+set(BLEMB_IMPLEMENTATION_FILES
+    internal/blemb_buffer.h
+    internal/blemb_binary.h
+    internal/blemb_crc8.h
+    internal/blemb_gf256.h
+    internal/blemb_frame.h
+    internal/blemb_lz.h
+    internal/blemb_scan.h
+    internal/blemb_stats.h
+    src/crc8.c
+    src/gf256.c
+    src/lz.c
+    src/scan.c
+    src/pool.c
+    src/protow.c
+    src/protoh.c
+    src/protod.c
+)
+
+function(blemb_amalgamate_append file)
+    # Read as a whole: C code is full of `;`, which would split a CMake list.
+    file(READ "${BLEMB_SOURCE_DIR}/${file}" content)
+    string(REGEX REPLACE "#include <blemb[/_][^\n]*\n" "" content "${content}")
+    
+    file(APPEND "${BLEMB_OUTPUT}.tmp" "\n// ----- ${file} -----\n\n${content}")
+endfunction()
+
+file(WRITE "${BLEMB_OUTPUT}.tmp"
+"//
+//  blemb.h
+//  BLEMB
+//
+//  Generated by cmake/amalgamate.cmake, do not edit.
+//
+//  Single-header build of blemb-proto. In exactly one translation unit:
+//
+//      #define BLEMB_IMPLEMENTATION
+//      #include \"blemb.h\"
+//
+
+#ifndef BLEMB_H
+#define BLEMB_H
+")
+
+foreach(file IN LISTS BLEMB_PUBLIC_HEADERS)
+    blemb_amalgamate_append(${file})
+endforeach()
+
+file(APPEND "${BLEMB_OUTPUT}.tmp" "\n#endif\n\n#ifdef BLEMB_IMPLEMENTATION\n#ifndef BLEMB_IMPLEMENTATION_INCLUDED\n#define BLEMB_IMPLEMENTATION_INCLUDED\n")
+
+foreach(file IN LISTS BLEMB_IMPLEMENTATION_FILES)
+    blemb_amalgamate_append(${file})
+endforeach()
+
+file(APPEND "${BLEMB_OUTPUT}.tmp" "\n#endif\n#endif\n")
+
+# Only touch the output when it changes, so dependents are not rebuilt for nothing.
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${BLEMB_OUTPUT}.tmp" "${BLEMB_OUTPUT}")
+file(REMOVE "${BLEMB_OUTPUT}.tmp")
@@ -0,0 +1,26 @@
+//
+//  blemb/crc8.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_CRC8_H
+#define BLEMB_CRC8_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+
+// Bluetooth CRC8 (polynom 0xA7), the checksum used by `protow` and `protoh`.
+//
+// Data can be checksummed as it streams:
+//
+//     blemb_byte_t crc = blemb_crc8_init();
+//     crc = blemb_crc8_update(crc, chunk_0);
+//     crc = blemb_crc8_update(crc, chunk_1);
+//     blemb_byte_t checksum = blemb_crc8_final(crc);
+extern blemb_byte_t blemb_crc8_init(void);
+extern blemb_byte_t blemb_crc8_update(blemb_byte_t crc, blemb_buffer_t data);
+extern blemb_byte_t blemb_crc8_final(blemb_byte_t crc);
+
+#endif
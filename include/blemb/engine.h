@@ -0,0 +1,65 @@
+//
+//  blemb/engine.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_ENGINE_H
+#define BLEMB_ENGINE_H
+
+// Multi-threaded receive engine for gateways (POSIX threads, C11 atomics).
+// Built as the separate `blemb-proto-engine` library.
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/protod.h>
+
+// One shard of the engine: a thread that owns a `protod` session table and
+// receives its fragments through a lock-free single-producer/single-consumer ring.
+// The `protod` handler and validator run on this thread, so sessions are never
+// shared between threads and reassembly needs no locks.
+typedef struct _blemb_engine_worker_t {
+    // Sessions and buffers of this shard. Configured by the caller.
+    blemb_protod_context_t sessions;
+    
+    // Ingress ring storage. `ring_size` must be a power of two, at least 64 bytes.
+    blemb_byte_t * ring_data;
+    blemb_uint32_t ring_size;
+    
+    // Optional. Pin the worker thread to core `cpu` (Linux only).
+    blemb_bool_t pin_cpu;
+    blemb_uint32_t cpu;
+    
+    // Managed internally by the library.
+    _Atomic blemb_uint32_t ring_head;
+    _Atomic blemb_uint32_t ring_tail;
+    _Atomic blemb_bool_t stopping;
+    pthread_t thread;
+} blemb_engine_worker_t;
+
+typedef struct _blemb_engine_t {
+    blemb_engine_worker_t * workers;
+    blemb_uint32_t worker_count;
+} blemb_engine_t;
+
+extern blemb_bool_t blemb_engine_start(blemb_engine_t * engine);
+
+// Drains every ring, then joins the worker threads.
+extern void blemb_engine_stop(blemb_engine_t * engine);
+
+// Queues a fragment for the worker owning `connection_id`. The data is copied.
+// Must always be called from the same thread (single producer). Returns
+// `BLEMB_FALSE`, without blocking, when the worker's ring is full.
+extern blemb_bool_t blemb_engine_submit(blemb_engine_t * engine, blemb_uint32_t connection_id, blemb_buffer_t data);
+
+// Queues the closing of `connection_id` (see `blemb_protod_close`). Same rules as `submit`.
+extern blemb_bool_t blemb_engine_close(blemb_engine_t * engine, blemb_uint32_t connection_id);
+
+// Index of the worker that owns `connection_id`.
+extern blemb_uint32_t blemb_engine_worker_index(blemb_engine_t * engine, blemb_uint32_t connection_id);
+
+#endif
@@ -0,0 +1,75 @@
+//
+//  blemb/frame.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_FRAME_H
+#define BLEMB_FRAME_H
+
+#include <blemb/types.h>
+
+// Wire formats understood by `protow` and `protoh`. Both ends of a link must use
+// the same one: it is selected per context, V1 being the default.
+//
+// V1: magic (1) + big-endian payload size (2) + payload + CRC8 (1). Up to 65535 bytes.
+// V2: magic (1) + LEB128 payload size (1-4) + payload + CRC8 (1). Sizes below 128 take
+//     a single byte, the largest payload is `BLEMB_FRAME_V2_MAX_PAYLOAD_SIZE`. Sizes
+//     must be encoded with the fewest bytes, anything else is rejected.
+typedef blemb_uint8_t blemb_frame_format_t;
+#define BLEMB_FRAME_FORMAT_V1 0
+#define BLEMB_FRAME_FORMAT_V2 1
+
+// Optional flag, OR-ed into either format: `BLEMB_FRAME_FORMAT_V2 | BLEMB_FRAME_FLAG_HEADER_CHECK`.
+// A CRC8 of the magic and size bytes follows the size, so receivers reject a false magic
+// match as soon as its header is in, instead of buffering the claimed payload and
+// checksumming it. Costs one byte per message.
+#define BLEMB_FRAME_FLAG_HEADER_CHECK 0x80
+
+// Optional flag, OR-ed into either format (and combined with the header check, if need be).
+// The payload starts with an encoding byte, counted in its size and checksum:
+// `BLEMB_FRAME_ENCODING_RAW`, the message follows as is, or `BLEMB_FRAME_ENCODING_LZ`, it
+// follows compressed (see `blemb/lz.h`). Senders pick raw whenever compression does not
+// make the message smaller. Costs one byte per message.
+#define BLEMB_FRAME_FLAG_COMPRESSION 0x40
+#define BLEMB_FRAME_ENCODING_RAW 0
+#define BLEMB_FRAME_ENCODING_LZ 1
+
+// Reliable mode (see `blemb_protow_write_reliable`): a framed message is cut into
+// fragments of `mtu - BLEMB_FRAME_FRAGMENT_OVERHEAD` bytes, one per packet:
+//
+//     sequence (1) + index (2, big-endian) + fragment bytes + CRC8 of all previous bytes (1)
+//
+// The sequence tells messages apart. The top bit of the index marks the last fragment,
+// indexes go up to `BLEMB_FRAME_FRAGMENT_MAX_COUNT - 1`.
+//
+// With forward error correction, fragments are of `mtu - BLEMB_FRAME_PARITY_OVERHEAD` bytes
+// and every group of N data fragments (`fec_data_count`, fewer in the last group) is
+// followed by K parity fragments (`fec_parity_count`, up to `BLEMB_FRAME_FEC_MAX_PARITY_COUNT`):
+//
+//     sequence (1) + index (2, big-endian) + data fragments in the group (1) + parity bytes + CRC8 (1)
+//
+// Their index has its second bit set and holds `group * K + row`, their parity bytes are
+// always as many as in a full fragment. The count of data fragments tells the size of the
+// group, and of the message when it is below N, so any fragment can be rebuilt before the
+// message size is known. Parity row `j` is the sum, in GF(2^8) with polynom 0x11D, of `c(j, i) * fragment i` over the
+// zero-padded fragments `i` of the group, with `c(j, i) = (N ^ i) / ((N + j) ^ i)`: row 0
+// is a plain xor and any K fragments of a group can be rebuilt from the others.
+//
+// The receiver answers with reports:
+//
+//     sequence (1) + missing fragment indexes (2 each, big-endian)
+//
+// An index with `BLEMB_FRAME_REPORT_FROM` set stands for that fragment and every one after
+// it. A report without indexes acknowledges the whole message.
+#define BLEMB_FRAME_FRAGMENT_OVERHEAD 4
+#define BLEMB_FRAME_PARITY_OVERHEAD 5
+#define BLEMB_FRAME_FRAGMENT_MAX_COUNT 0x4000
+#define BLEMB_FRAME_REPORT_FROM 0x8000
+#define BLEMB_FRAME_FEC_MAX_PARITY_COUNT 8
+
+#define BLEMB_FRAME_V1_MAX_PAYLOAD_SIZE BLEMB_UINT16_MAX
+#define BLEMB_FRAME_V2_MAX_PAYLOAD_SIZE 0x0FFFFFFF
+
+#endif
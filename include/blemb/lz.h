@@ -0,0 +1,52 @@
+//
+//  blemb/lz.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_LZ_H
+#define BLEMB_LZ_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+
+// Small-window LZ77, the compression stage of `protow` and `protoh` (see
+// `BLEMB_FRAME_FLAG_COMPRESSION`). Compressed data is a sequence of:
+//
+//     0LLLLLLL + L + 1 literal bytes
+//     1LLLLDDD DDDDDDDD [+ length bytes]: copy of L + 3 bytes from D + 1 bytes back
+//
+// A copy with L = 15 goes on with length bytes, each added to its length, until one
+// is below 255. Copies may overlap the bytes they produce and reach back up to
+// `BLEMB_LZ_WINDOW_SIZE` bytes, past the start of the data into the last bytes of the
+// dictionary. The dictionary is optional and shared by both ends beforehand, e.g.
+// typical messages: it lets the first bytes of every message be copies too.
+#define BLEMB_LZ_WINDOW_SIZE 2048
+#define BLEMB_LZ_MIN_COPY 3
+
+// State of a decoder fed piece by piece (see `blemb_protoh_context_t.decompress_data`).
+// Managed internally by the library.
+typedef struct _blemb_lz_decoder_t {
+    const blemb_byte_t * dictionary;
+    blemb_size_t dictionary_size;
+    blemb_byte_t * window;                  // Ring of decoded bytes.
+    blemb_size_t window_size;
+    blemb_size_t window_head;               // Where the next decoded byte goes.
+    blemb_size_t produced;                  // Bytes decoded so far.
+    blemb_size_t pending;                   // Decoded bytes not handed out yet.
+    blemb_size_t length;                    // Bytes left in the current literal run or copy.
+    blemb_uint16_t distance;
+    blemb_uint8_t state;
+} blemb_lz_decoder_t;
+
+// Compresses `input` into `output`. Returns `BLEMB_FALSE` when the result does not fit
+// in `output.size` bytes: pass `input.size - 1` to only accept a gain. The work memory
+// is 512 bytes of stack.
+extern blemb_bool_t blemb_lz_compress(blemb_buffer_t dictionary, blemb_buffer_t input, blemb_buffer_t output, blemb_size_t * output_size);
+
+// Decompresses `input` into `output`. Returns `BLEMB_FALSE` when it is malformed or does
+// not fit in `output.size` bytes.
+extern blemb_bool_t blemb_lz_decompress(blemb_buffer_t dictionary, blemb_buffer_t input, blemb_buffer_t output, blemb_size_t * output_size);
+
+#endif
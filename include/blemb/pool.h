@@ -0,0 +1,31 @@
+//
+//  blemb/pool.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_POOL_H
+#define BLEMB_POOL_H
+
+#include <blemb/types.h>
+
+// Fixed-size block allocator over caller-provided memory: `data` must hold
+// `block_count * block_size` bytes and `block_size` must be at least 4 bytes.
+// No dynamic memory is used. All allocations and releases are O(1).
+typedef struct _blemb_pool_t {
+    blemb_byte_t * data;
+    blemb_uint32_t block_size;
+    blemb_uint32_t block_count;
+    
+    // Managed internally by the library: must be zero on startup.
+    blemb_uint32_t free_head;
+    blemb_uint32_t next_unused;
+    blemb_uint32_t used_count;
+} blemb_pool_t;
+
+// Returns a block of `block_size` bytes, or `NULL` when the pool is exhausted.
+extern blemb_byte_t * blemb_pool_alloc(blemb_pool_t * pool);
+extern void blemb_pool_free(blemb_pool_t * pool, blemb_byte_t * block);
+
+#endif
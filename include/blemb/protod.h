@@ -0,0 +1,74 @@
+//
+//  blemb/protod.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PROTOD_H
+#define BLEMB_PROTOD_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/pool.h>
+#include <blemb/protoh.h>
+
+struct _blemb_protod_context_t;
+
+typedef void (*blemb_protod_message_handler_f)(struct _blemb_protod_context_t * context, blemb_uint32_t connection_id, blemb_buffer_t message);
+
+// One entry of the session table. Managed internally by the library: the
+// table must be zeroed on startup.
+typedef struct _blemb_protod_session_t {
+    blemb_bool_t used;
+    blemb_uint32_t connection_id;
+    blemb_protoh_context_t parser;
+} blemb_protod_session_t;
+
+// Demultiplexes the fragments of many peers (connections) into per-peer `protoh`
+// parsers. Idle sessions hold no reassembly buffer: a block is taken from `pool`
+// when a message starts and returned as soon as nothing is buffered anymore.
+// Each `pool` block must hold the largest expected message (payload + 4 bytes in
+// V1, up to payload + 6 bytes in V2).
+typedef struct _blemb_protod_context_t {
+    blemb_byte_t magic;
+    
+    // Optional. Wire format of every peer, `BLEMB_FRAME_FORMAT_V1` (zero) by default.
+    blemb_frame_format_t format;
+    
+    blemb_protod_session_t * sessions;
+    blemb_uint32_t session_max_count;
+    
+    blemb_pool_t pool;
+    
+    blemb_protoh_message_validator_f validator;
+    blemb_protod_message_handler_f handler;
+    
+    // Optional. Decompression for a format with `BLEMB_FRAME_FLAG_COMPRESSION` (see
+    // `blemb_protoh_context_t.decompress_data`). The buffer is shared by all sessions, as
+    // messages are decoded right before `handler` is called.
+    blemb_byte_t * decompress_data;
+    blemb_uint32_t decompress_max_size;
+    blemb_buffer_t compression_dictionary;
+    
+    // Optional. Counters shared by the parsers of all sessions.
+    blemb_protoh_stats_t * stats;
+    
+    // Optional. Not used by the library.
+    void * user_data;
+} blemb_protod_context_t;
+
+// Feeds a fragment received from `connection_id`, opening its session if needed.
+// Returns `BLEMB_FALSE` when the session table is full or no buffer is available.
+// Do not call `protod` functions on the same context from `handler` or `validator`.
+extern blemb_bool_t blemb_protod_handle(blemb_protod_context_t * context, blemb_uint32_t connection_id, blemb_buffer_t data);
+
+// Feeds a packet of a multiplexed link (see `blemb_protow_context_t.streams`): its first
+// byte is the stream index, which selects the session. `handler` receives it as
+// `connection_id`. Use one context per multiplexed link.
+extern blemb_bool_t blemb_protod_handle_multiplexed(blemb_protod_context_t * context, blemb_buffer_t packet);
+
+// Forgets `connection_id`, dropping any partially received message.
+extern void blemb_protod_close(blemb_protod_context_t * context, blemb_uint32_t connection_id);
+
+#endif
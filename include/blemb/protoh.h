@@ -10,21 +10,213 @@
 
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/frame.h>
+#include <blemb/lz.h>
 
 typedef blemb_bool_t (*blemb_protoh_message_validator_f)(blemb_buffer_t);
 typedef void (*blemb_protoh_message_handler_f)(blemb_buffer_t);
 
+struct _blemb_protoh_context_t;
+
+// Counters updated by `blemb_protoh_handle` when the library is built with
+// `BLEMB_PROTO_STATS`. Without it, counting is compiled out and they stay at zero.
+typedef struct _blemb_protoh_stats_t {
+    blemb_uint64_t bytes_ingested;          // Bytes passed to `blemb_protoh_handle`.
+    blemb_uint64_t messages_delivered;      // Messages handed to the handler.
+    blemb_uint64_t crc_mismatches;          // Complete candidates with a wrong checksum.
+    blemb_uint64_t resync_discarded_bytes;  // Bytes dropped while looking for a message.
+    blemb_uint64_t validator_rejects;       // Messages refused by the validator or the header validator.
+    blemb_uint64_t overflow_skips;          // Candidates skipped because they do not fit in the buffer.
+    blemb_uint64_t header_rejects;          // Candidates with a malformed header or a wrong header check.
+    blemb_uint64_t fragments_recovered;     // Fragments rebuilt from parity (reliable mode).
+    blemb_uint64_t decompress_failures;     // Compressed messages that did not decode, or did not fit in `decompress_data`.
+} blemb_protoh_stats_t;
+
+// A possible message start tracked in bounded mode (see `candidates` below).
+// Managed internally by the library.
+typedef struct _blemb_protoh_candidate_t {
+    blemb_uint32_t offset;      // Position of the magic byte in the buffer.
+    blemb_uint32_t checked;     // Payload bytes already checksummed.
+    blemb_uint32_t length;      // Payload size, once the header is complete.
+    blemb_uint8_t state;
+    blemb_byte_t crc;
+} blemb_protoh_candidate_t;
+
+// Receives a message as two consecutive pieces: `second` is only non-empty when the
+// message wraps around the end of a ring buffer. `context` gives access to `user_data`.
+typedef void (*blemb_protoh_message_span_handler_f)(struct _blemb_protoh_context_t * context, blemb_buffer_t first, blemb_buffer_t second);
+
+// Streaming delivery (see `on_chunk` below): a message is announced with its payload
+// size, handed over in pieces as they arrive and closed with the checksum result.
+typedef void (*blemb_protoh_stream_begin_f)(struct _blemb_protoh_context_t * context, blemb_size_t length);
+typedef void (*blemb_protoh_stream_chunk_f)(struct _blemb_protoh_context_t * context, blemb_buffer_t chunk);
+typedef void (*blemb_protoh_stream_end_f)(struct _blemb_protoh_context_t * context, blemb_bool_t crc_ok);
+
+// Decides whether a message is wanted from its payload size alone (see `header_validator` below).
+typedef blemb_bool_t (*blemb_protoh_header_validator_f)(struct _blemb_protoh_context_t * context, blemb_size_t length);
+
 typedef struct _blemb_protoh_context_t {
     blemb_byte_t magic;
     
+    // Optional. Wire format, `BLEMB_FRAME_FORMAT_V1` (zero) by default. The buffer must
+    // hold, at least, an empty message and the largest header: 4 bytes in V1, 5 in V2,
+    // one more with `BLEMB_FRAME_FLAG_HEADER_CHECK`.
+    blemb_frame_format_t format;
+    
     blemb_uint8_t * buffer_data;
     blemb_uint32_t buffer_cur_size;
     blemb_uint32_t buffer_max_size;
     
+    // Optional. When `BLEMB_TRUE`, `buffer_data` is used as a circular buffer: consuming
+    // bytes only advances `buffer_head`, buffered data is never moved to the front.
+    blemb_bool_t buffer_ring;
+    blemb_uint32_t buffer_head;
+    
+    // Messages are handed over as slices of `buffer_data` or, when they arrive whole in
+    // a single `blemb_protoh_handle` call, of its input. Only valid during the call.
     blemb_protoh_message_validator_f validator;
     blemb_protoh_message_handler_f handler;
+    
+    // Optional. Called as soon as the payload size of a candidate is known, before checking
+    // that the message fits in the buffer. When it returns `BLEMB_FALSE`, the claimed bytes
+    // are dropped as they arrive, without being buffered or checksummed, whatever their
+    // size. A false magic match refused this way takes real messages down with it: pair
+    // it with `BLEMB_FRAME_FLAG_HEADER_CHECK` on noisy links. In bounded mode the bytes of
+    // a refused candidate are dropped once the candidates before it are ruled out.
+    blemb_protoh_header_validator_f header_validator;
+    
+    // Optional. When set, it is used instead of `handler` and messages that wrap around
+    // the end of the ring are handed over without being made contiguous first. Messages
+    // are still made contiguous when a `validator` is set.
+    blemb_protoh_message_span_handler_f span_handler;
+    
+    // Optional. Streaming mode: when `on_chunk` is set, payload bytes are forwarded as they
+    // arrive, straight from the data passed to `blemb_protoh_handle`, and only the header
+    // is buffered, so `buffer_max_size` can be as small as a header whatever the message
+    // size. Chunks are only valid during the call. Nothing is known about a message
+    // until `on_end`: discard what was received when `crc_ok` is `BLEMB_FALSE`, which is
+    // also the case for a compressed message that does not decode.
+    // `validator`, `handler`, `span_handler` and bounded mode are not used; `header_validator` is.
+    blemb_protoh_stream_begin_f on_begin;
+    blemb_protoh_stream_chunk_f on_chunk;
+    blemb_protoh_stream_end_f on_end;
+    
+    // Optional. Compression, with `BLEMB_FRAME_FLAG_COMPRESSION` in `format`: compressed
+    // messages are decoded into `decompress_data` (`decompress_max_size` bytes) before
+    // `validator` and `handler` see them, and dropped when they do not fit. In streaming
+    // mode it is the decoder's window instead, so it does not depend on the message size:
+    // with `BLEMB_LZ_WINDOW_SIZE` bytes every message decodes, `on_chunk` receives decoded
+    // bytes and `on_begin` the size as sent. `compression_dictionary` must match the sender's.
+    blemb_byte_t * decompress_data;
+    blemb_uint32_t decompress_max_size;
+    blemb_buffer_t compression_dictionary;
+    
+    // Optional. Not used by the library, available to callbacks that receive the context.
+    void * user_data;
+    
+    // Optional. Counters block, may be shared between contexts of the same thread.
+    blemb_protoh_stats_t * stats;
+    
+    // Optional. Bounded mode: up to `candidate_max_count` possible message starts are
+    // followed at once and every buffered byte is scanned and checksummed at most once
+    // per tracked candidate, so the work per input byte never exceeds
+    // `candidate_max_count + 1` steps. Magic bytes found while the array is full are
+    // ignored for good. Set it up before the first call.
+    blemb_protoh_candidate_t * candidates;
+    blemb_uint32_t candidate_max_count;
+    blemb_uint32_t candidate_count;             // Managed internally: must be zero on startup.
+    
+    // Optional. Maximum number of byte steps (scans and checksum updates) done by one
+    // `blemb_protoh_handle_partial` call. Zero means no limit. It is only a hard bound
+    // in bounded mode: otherwise a single resynchronization may go over it.
+    blemb_uint32_t work_budget;
+    
+    // Optional. Reliable mode (see `blemb_protoh_handle_reliable`): one bit per fragment of
+    // the message being received. It must hold, at least,
+    // `buffer_max_size / (mtu - BLEMB_FRAME_FRAGMENT_OVERHEAD) / 8 + 1` bytes
+    // (`BLEMB_FRAME_PARITY_OVERHEAD` with forward error correction).
+    blemb_byte_t * fragment_map;
+    blemb_uint32_t fragment_map_size;
+    
+    // Optional. Forward error correction in reliable mode: must match the sender's
+    // `fec_data_count` and `fec_parity_count`. Parity fragments wait in `fec_buffer` until
+    // their group can be rebuilt, one group per `4 + fec_parity_count * (mtu - 5)` bytes;
+    // without room they are dropped. Each one tells the size of its group, so any fragment
+    // can be rebuilt, fragment 0 of a message of a single group too. Zero: parity fragments
+    // are ignored.
+    blemb_uint8_t fec_data_count;
+    blemb_uint8_t fec_parity_count;
+    blemb_byte_t * fec_buffer;
+    blemb_uint32_t fec_buffer_size;
+    
+    // Reliable reassembly state. Managed internally by the library: must be zero on startup.
+    blemb_uint8_t fragment_state;
+    blemb_uint8_t fragment_sequence;
+    blemb_uint32_t fragment_size;               // Zero until a full-size fragment is in.
+    blemb_uint32_t fragment_count;              // Zero until the last fragment, or the message header, is in.
+    blemb_uint32_t fragment_received;
+    blemb_uint32_t fragment_end;                // One past the highest index seen.
+    blemb_uint32_t fragment_parked;             // Size of a last fragment kept at the end of `buffer_data` until `fragment_size` is known.
+    
+    // Reassembly state kept between `blemb_protoh_handle` calls.
+    // Managed internally by the library: must be zero on startup.
+    blemb_uint8_t parser_state;
+    blemb_uint32_t parser_offset;
+    blemb_uint32_t parser_length;
+    blemb_byte_t parser_crc;
+    blemb_uint8_t parser_encoding;
+    blemb_lz_decoder_t decoder;                 // Streaming mode, for compressed messages.
 } blemb_protoh_context_t;
 
 extern blemb_bool_t blemb_protoh_handle(blemb_protoh_context_t * context, blemb_buffer_t data);
 
+// Same as `blemb_protoh_handle`, but stops once `work_budget` is spent. `consumed` receives
+// the number of bytes taken from `data`: the rest must be passed again in a later call.
+extern blemb_bool_t blemb_protoh_handle_partial(blemb_protoh_context_t * context, blemb_buffer_t data, blemb_size_t * consumed);
+
+// Direct receive: instead of handing data over, write it straight into the reassembly
+// buffer. `blemb_protoh_window` returns the free space past the buffered bytes (it may
+// be smaller than the free space in ring mode, when it wraps), then `blemb_protoh_commit`
+// processes the first `size` bytes written to it, delivering any completed message.
+// In bounded mode the window is limited to the bytes the first candidate needs, so a
+// block never brings in more message starts than can be tracked: expect smaller reads.
+// `blemb_protoh_bytes_needed` tells how many more bytes the current message needs, to
+// size the next read; it never exceeds the free space. In streaming mode only the hint
+// is available, and it counts the rest of the message.
+//
+//     blemb_buffer_t window;
+//     blemb_protoh_window(&context, &window);
+//     ssize_t size = read(fd, window.data, window.size);
+//     if (size > 0) blemb_protoh_commit(&context, size);
+extern blemb_bool_t blemb_protoh_window(blemb_protoh_context_t * context, blemb_buffer_t * window);
+extern blemb_bool_t blemb_protoh_commit(blemb_protoh_context_t * context, blemb_size_t size);
+extern blemb_size_t blemb_protoh_bytes_needed(blemb_protoh_context_t * context);
+
+// Reliable mode: every call takes one whole packet written by `blemb_protow_write_reliable`.
+// Fragments may arrive in any order, are checked one by one and placed straight into
+// `buffer_data`; bad ones are dropped, and rebuilt from parity when `fec_buffer` is set.
+// Once all are in, the message is checked as usual and handed to `validator` and
+// `handler`. Ring, bounded and streaming modes are not used. The packets of every lane
+// of a striped sender (see `blemb_protow_context_t.lanes`) go to the same context.
+// Sequences are compared modulo 256: fragments of a sequence older than the current one
+// are late duplicates and are dropped, so reset the reliable state when the sender restarts.
+// A slow lane may deliver fragments of a message after the next one has started: being
+// from an older sequence, they are discarded.
+//
+// `blemb_protoh_reliable_report` writes the report to send back to the sender: the
+// fragments still missing, as many as fit in `report` (at least 3 bytes), or an
+// acknowledgement once the message is delivered. Send one after every burst of packets
+// (of every lane, when striped: fragments still on their way are listed as missing and
+// sent twice, the late copy is dropped) and
+// when none has arrived for a while. It returns `BLEMB_FALSE` when no fragment has been
+// received yet: until then the sender's timer drives the retries (see
+// `blemb_protow_resend_reliable`).
+extern blemb_bool_t blemb_protoh_handle_reliable(blemb_protoh_context_t * context, blemb_buffer_t packet);
+extern blemb_bool_t blemb_protoh_reliable_report(blemb_protoh_context_t * context, blemb_buffer_t report, blemb_size_t * report_size);
+
+// Copies the counters of the attached stats block (zeros when there is none), or clears
+// them. Call them from the thread that calls `blemb_protoh_handle`.
+extern void blemb_protoh_stats_snapshot(blemb_protoh_context_t * context, blemb_protoh_stats_t * snapshot);
+extern void blemb_protoh_stats_reset(blemb_protoh_context_t * context);
+
 #endif
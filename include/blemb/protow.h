@@ -10,16 +10,213 @@
 
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/frame.h>
 
 typedef void (*blemb_protow_writer_f)(blemb_buffer_t);
 
+// Scatter/gather writer: each packet is the concatenation of `head`, `body` and `tail`,
+// any of which may be empty. `body` always points straight into the caller's payload,
+// `head` and `tail` hold the message header and checksum bytes of the packet.
+typedef void (*blemb_protow_gather_writer_f)(blemb_buffer_t head, blemb_buffer_t body, blemb_buffer_t tail);
+
+// Counters updated by `blemb_protow_write` and `blemb_protow_next` when the library is
+// built with `BLEMB_PROTO_STATS`. Without it, counting is compiled out and they stay at zero.
+typedef struct _blemb_protow_stats_t {
+    blemb_uint64_t messages_written;        // Messages whose last packet has been emitted (or staged, when batching).
+    blemb_uint64_t packets_emitted;         // Packets passed to the writer or pulled.
+    blemb_uint64_t bytes_emitted;           // Bytes of those packets, framing included.
+    blemb_uint64_t fragments_resent;        // Fragments sent again on a receiver's report (reliable mode).
+    blemb_uint64_t parity_emitted;          // Parity fragments sent (forward error correction).
+    blemb_uint64_t compression_saved_bytes; // Payload bytes saved by compression.
+} blemb_protow_stats_t;
+
+// State of a message being written packet by packet (see `blemb_protow_begin`).
+// Managed internally by the library.
+typedef struct _blemb_protow_iterator_t {
+    blemb_buffer_t payload;
+    blemb_size_t message_size;
+    blemb_offset_t offset;                  // Next message byte to emit.
+    blemb_uint16_t mtu;
+    blemb_uint8_t header_size;
+    blemb_byte_t header[7];                 // Frame header, then the encoding byte of a compressed format.
+    blemb_byte_t trailer[1];
+    blemb_protow_stats_t * stats;
+} blemb_protow_iterator_t;
+
+// A message waiting in the outbound queue (see `blemb_protow_submit`).
+// Managed internally by the library.
+typedef struct _blemb_protow_queue_entry_t {
+    blemb_protow_iterator_t iterator;
+    void * tag;
+} blemb_protow_queue_entry_t;
+
+// One logical stream of a multiplexed context (see `streams`). Only `priority` is set by
+// the application, the other fields are managed internally and must be zero on startup.
+typedef struct _blemb_protow_stream_t {
+    blemb_uint8_t priority;                 // Higher goes first.
+    blemb_bool_t busy;
+    void * tag;
+    blemb_protow_iterator_t iterator;
+} blemb_protow_stream_t;
+
+// One lane of a striped context (see `lanes`). `writer` and `weight` are set by the
+// application, `credit` is managed internally and must be zero on startup.
+typedef struct _blemb_protow_lane_t {
+    blemb_protow_writer_f writer;
+    blemb_uint8_t weight;                   // Share of the fragments, relative to the other lanes. Zero counts as one.
+    blemb_int32_t credit;
+} blemb_protow_lane_t;
+
+struct _blemb_protow_context_t;
+
+// Result of a non-blocking writer: `BLEMB_PROTOW_WOULD_BLOCK` leaves the packet with the
+// library, which offers it again on the next `blemb_protow_pump`.
+typedef blemb_uint8_t blemb_protow_result_t;
+#define BLEMB_PROTOW_ACCEPTED 0
+#define BLEMB_PROTOW_WOULD_BLOCK 1
+
+typedef blemb_protow_result_t (*blemb_protow_try_writer_f)(struct _blemb_protow_context_t * context, blemb_buffer_t packet);
+
+// Called once the last packet of a submitted message has been accepted, or a reliable
+// message acknowledged: `data` and the memory it points to are no longer used by the library.
+typedef void (*blemb_protow_complete_f)(struct _blemb_protow_context_t * context, blemb_buffer_t data, void * tag);
+
 typedef struct _blemb_protow_context_t {
     blemb_byte_t magic;
     blemb_uint16_t mtu;
     
+    // Optional. Wire format, `BLEMB_FRAME_FORMAT_V1` (zero) by default.
+    blemb_frame_format_t format;
+    
     blemb_protow_writer_f writer;
+    
+    // Optional. When set, it is used instead of `writer` and no packet is copied.
+    blemb_protow_gather_writer_f gather_writer;
+    
+    // Optional. Counters block, may be shared between contexts of the same thread.
+    blemb_protow_stats_t * stats;
+    
+    // Optional. Compression, with `BLEMB_FRAME_FLAG_COMPRESSION` in `format`: `blemb_protow_write`
+    // compresses every payload into `compress_data` (`compress_max_size` bytes) and sends
+    // the result when it is smaller, the payload as is otherwise. Without `compress_data`,
+    // and in every other way of sending, payloads go out as is. `compression_dictionary`
+    // must match the receiver's.
+    blemb_byte_t * compress_data;
+    blemb_uint32_t compress_max_size;
+    blemb_buffer_t compression_dictionary;
+    
+    // Optional. Batching: when `batch_data` (at least `mtu` bytes) is set, messages are
+    // written back to back and cut into packets of exactly `mtu` bytes, so small messages
+    // share packets and a message may start in one packet and end in the next. The last,
+    // partial packet is held in `batch_data` until it is full, until `batch_threshold`
+    // bytes are pending (zero: only when full) or until `blemb_protow_flush` is called.
+    // Not used by `blemb_protow_begin`.
+    blemb_byte_t * batch_data;
+    blemb_uint16_t batch_threshold;
+    blemb_uint16_t batch_size;                  // Managed internally: must be zero on startup.
+    
+    // Optional. Asynchronous sending: `blemb_protow_submit` queues messages in `queue`
+    // (up to `queue_max_count`) and packets go out through `try_writer`, which may refuse
+    // them while the transport is full. `writer`, `gather_writer` and batching are not used.
+    blemb_protow_try_writer_f try_writer;
+    blemb_protow_complete_f on_complete;
+    blemb_protow_queue_entry_t * queue;
+    blemb_uint32_t queue_max_count;
+    blemb_uint32_t queue_head;                  // Managed internally: must be zero on startup.
+    blemb_uint32_t queue_count;                 // Managed internally: must be zero on startup.
+    
+    // Optional. Multiplexing: each of the `stream_count` streams (up to 256) carries one
+    // message at a time, submitted with `blemb_protow_stream_submit`, and `blemb_protow_pump`
+    // interleaves their packets through `try_writer`, so a bulk transfer does not hold the
+    // link. Every packet starts with its stream index and carries `mtu - 1` message bytes.
+    // The busy stream with the highest `priority` sends next, equal ones take turns packet
+    // by packet. Receive with `blemb_protod_handle_multiplexed`. `queue` is not used and
+    // `blemb_protow_write` is refused.
+    blemb_protow_stream_t * streams;
+    blemb_uint32_t stream_count;
+    blemb_uint32_t stream_next;                 // Managed internally: must be zero on startup.
+    
+    // Optional. Forward error correction in reliable mode: `fec_parity_count` parity
+    // fragments (up to `BLEMB_FRAME_FEC_MAX_PARITY_COUNT`) follow every `fec_data_count`
+    // data fragments, so the receiver rebuilds up to that many lost or corrupted fragments
+    // per group without waiting for a report. Both must match the receiver's. Fragments
+    // are then one byte shorter: parity fragments carry the size of their group. Zero: off.
+    blemb_uint8_t fec_data_count;
+    blemb_uint8_t fec_parity_count;
+    
+    // Optional. Striping in reliable mode: fragments, parity and resent fragments are
+    // spread over the `lane_count` lanes (e.g. several characteristics or L2CAP channels)
+    // instead of `writer`, each lane getting a share given by its `weight`; equal weights
+    // take turns packet by packet. The receiver passes the packets of every lane to the
+    // same `protoh` context, in whatever order they arrive; fragments of an older message
+    // that arrive late on a slow lane are discarded.
+    blemb_protow_lane_t * lanes;
+    blemb_uint32_t lane_count;
+    
+    // Reliable mode (see `blemb_protow_write_reliable`): the message waiting for the
+    // receiver's acknowledgement. Managed internally: must be zero on startup.
+    blemb_protow_queue_entry_t reliable_entry;
+    blemb_bool_t reliable_pending;
+    blemb_uint8_t reliable_sequence;
+    
+    // Optional. Not used by the library, available to callbacks that receive the context.
+    void * user_data;
 } blemb_protow_context_t;
 
 extern blemb_bool_t blemb_protow_write(blemb_protow_context_t * context, blemb_buffer_t data);
 
+// Emits the pending packet of a batching context, if any.
+extern blemb_bool_t blemb_protow_flush(blemb_protow_context_t * context);
+
+// Pull-based writing: `blemb_protow_begin` prepares a message, then every `blemb_protow_next`
+// call copies one packet into a caller-owned buffer. `writer`, `gather_writer` and the
+// context itself are not used after `blemb_protow_begin`; the payload must stay valid
+// until the last packet has been pulled.
+extern blemb_bool_t blemb_protow_begin(blemb_protow_context_t * context, blemb_protow_iterator_t * iterator, blemb_buffer_t data);
+extern blemb_bool_t blemb_protow_has_next(blemb_protow_iterator_t * iterator);
+
+// Returns `BLEMB_FALSE`, without moving the iterator, when no packet is left or when
+// `packet` is smaller than the next one (a buffer of `mtu` bytes is always enough).
+// `packet_size` receives the number of bytes written to `packet.data`.
+extern blemb_bool_t blemb_protow_next(blemb_protow_iterator_t * iterator, blemb_buffer_t packet, blemb_size_t * packet_size);
+
+// Queues a message for asynchronous sending and sends what the transport takes right
+// away. Returns `BLEMB_FALSE` when the queue is full or the message is invalid. `data`
+// must stay valid until `on_complete` reports it, with the same `tag`.
+extern blemb_bool_t blemb_protow_submit(blemb_protow_context_t * context, blemb_buffer_t data, void * tag);
+
+// Starts sending a message on stream `stream_id` of a multiplexed context. Returns
+// `BLEMB_FALSE` when the stream is still busy with a previous message.
+extern blemb_bool_t blemb_protow_stream_submit(blemb_protow_context_t * context, blemb_uint8_t stream_id, blemb_buffer_t data, void * tag);
+
+// Reliable mode: sends a message through `writer` (or `lanes`) as numbered, individually checksummed
+// fragments (see `blemb/frame.h`) and keeps it until the receiver acknowledges it. Pass
+// every report of the receiver to `blemb_protow_handle_report`: only the fragments it
+// lists as missing are sent again, and once the message is acknowledged `on_complete`
+// releases `data`, with the same `tag`. One message is kept at a time, so this returns
+// `BLEMB_FALSE` while the previous one is unacknowledged. Every packet carries
+// `mtu - BLEMB_FRAME_FRAGMENT_OVERHEAD` message bytes, `mtu - BLEMB_FRAME_PARITY_OVERHEAD` with
+// forward error correction.
+extern blemb_bool_t blemb_protow_write_reliable(blemb_protow_context_t * context, blemb_buffer_t data, void * tag);
+
+// Returns `BLEMB_FALSE` for a malformed report. A report about the previous message
+// (the receiver has none of the pending one) sends the whole message again; reports
+// about another message are ignored.
+extern blemb_bool_t blemb_protow_handle_report(blemb_protow_context_t * context, blemb_buffer_t report);
+
+// Sends every fragment (and parity) of the pending reliable message again. The receiver
+// cannot report a message of which it has not received a single fragment: call this when
+// no report has arrived for a while after `blemb_protow_write_reliable` or the last
+// resend. Returns `BLEMB_FALSE` when no message is pending.
+extern blemb_bool_t blemb_protow_resend_reliable(blemb_protow_context_t * context);
+
+// Offers queued packets to `try_writer`, in order, until it would block or the queue is
+// empty. Call it whenever the transport has room again (e.g. on a credit or a "ready"
+// event). Returns `BLEMB_TRUE` once the queue is empty.
+extern blemb_bool_t blemb_protow_pump(blemb_protow_context_t * context);
+
+// Copies the counters of the attached stats block (zeros when there is none), or clears them.
+extern void blemb_protow_stats_snapshot(blemb_protow_context_t * context, blemb_protow_stats_t * snapshot);
+extern void blemb_protow_stats_reset(blemb_protow_context_t * context);
+
 #endif
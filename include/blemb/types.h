@@ -32,6 +32,11 @@ typedef uint32_t blemb_uint32_t;
 #define BLEMB_INT32_MAX INT32_MAX
 #define BLEMB_UINT32_MAX UINT32_MAX
 
+typedef int64_t blemb_int64_t;
+typedef uint64_t blemb_uint64_t;
+#define BLEMB_INT64_MAX INT64_MAX
+#define BLEMB_UINT64_MAX UINT64_MAX
+
 typedef uint32_t blemb_size_t;
 #define BLEMB_SIZE_MAX UINT32_MAX
 
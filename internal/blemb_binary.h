@@ -8,47 +8,378 @@
 #ifndef BLEMB_PRIVATE_BINARY_H
 #define BLEMB_PRIVATE_BINARY_H
 
+#include <stddef.h>
+
 #include <blemb/types.h>
 #include <blemb/buffer.h>
 
+#include <blemb_buffer.h>
+
 typedef blemb_uint8_t blemb_binary_endianness_t;
 #define BLEMB_BINARY_ENDIANNESS_LITTLE 0
 #define BLEMB_BINARY_ENDIANNESS_BIG 1
 
+// Host byte order, resolved at compile time from the compiler's predefined macros.
+// Define `BLEMB_BINARY_ENDIANNESS_HOST` to one of the values above when none is available.
+#ifndef BLEMB_BINARY_ENDIANNESS_HOST
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BLEMB_BINARY_ENDIANNESS_HOST BLEMB_BINARY_ENDIANNESS_BIG
+#elif defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BLEMB_BINARY_ENDIANNESS_HOST BLEMB_BINARY_ENDIANNESS_LITTLE
+#elif defined(__BIG_ENDIAN__) || defined(__ARMEB__) || defined(__AARCH64EB__)
+#define BLEMB_BINARY_ENDIANNESS_HOST BLEMB_BINARY_ENDIANNESS_BIG
+#elif defined(__LITTLE_ENDIAN__) || defined(__ARMEL__) || defined(__AARCH64EL__) || defined(_WIN32)
+#define BLEMB_BINARY_ENDIANNESS_HOST BLEMB_BINARY_ENDIANNESS_LITTLE
+#else
+#error "Unknown host byte order: define BLEMB_BINARY_ENDIANNESS_HOST"
+#endif
+#endif
+
 typedef blemb_uint8_t blemb_binary_result_t;
 #define BLEMB_BINARY_RESULT_SUCCESS 0
 #define BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES 1
 
+// Everything below is `static inline`: with the byte order known at compile time,
+// a checked 16/32-bit access folds into a bounds check plus, at most, a byte swap.
+
+// -----
+// UTILS
+// -----
+static inline blemb_bool_t _blemb_binary_should_rotate(blemb_binary_endianness_t endianness) {
+    // Resolved at compile time: the whole branch folds away.
+    return endianness != BLEMB_BINARY_ENDIANNESS_HOST ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+// ----
 // BYTE
-extern blemb_binary_result_t blemb_binary_read_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t * result);
-extern blemb_binary_result_t blemb_binary_write_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value);
+// ----
+static inline blemb_byte_t _blemb_binary_read_unsafe_byte(blemb_byte_t * pointer) {
+    return *pointer;
+}
+static inline void _blemb_binary_write_unsafe_byte(blemb_byte_t * pointer, blemb_byte_t value) {
+    *pointer = value;
+}
 
+static inline blemb_binary_result_t blemb_binary_read_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_byte(buf.data);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_byte(buf.data, value);
+    
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+
+// ----
 // INT8
-extern blemb_binary_result_t blemb_binary_read_int8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_int8_t * result);
-extern blemb_binary_result_t blemb_binary_write_int8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_int8_t value);
+// ----
+static inline blemb_int8_t _blemb_binary_read_unsafe_int8(blemb_byte_t * pointer) {
+    return *((blemb_int8_t *)pointer);
+}
+static inline void _blemb_binary_write_unsafe_int8(blemb_byte_t * pointer, blemb_int8_t value) {
+    *((blemb_int8_t *)pointer) = value;
+}
+
+static inline blemb_binary_result_t blemb_binary_read_int8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_int8_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_int8(buf.data);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_int8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_int8_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_int8(buf.data, value);
+    
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
 
+// -----
 // UINT8
-extern blemb_binary_result_t blemb_binary_read_uint8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_uint8_t * result);
-extern blemb_binary_result_t blemb_binary_write_uint8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_uint8_t value);
+// -----
+static inline blemb_uint8_t _blemb_binary_read_unsafe_uint8(blemb_byte_t * pointer) {
+    return *((blemb_uint8_t *)pointer);
+}
+static inline void _blemb_binary_write_unsafe_uint8(blemb_byte_t * pointer, blemb_uint8_t value) {
+    *((blemb_uint8_t *)pointer) = value;
+}
 
+static inline blemb_binary_result_t blemb_binary_read_uint8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_uint8_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_uint8(buf.data);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_uint8(blemb_buffer_t buffer, blemb_offset_t offset, blemb_uint8_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 1);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_uint8(buf.data, value);
+    
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+
+// -----
 // INT16
-extern blemb_binary_result_t blemb_binary_read_int16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int16_t * result);
-extern blemb_binary_result_t blemb_binary_write_int16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int16_t value);
+// -----
+static inline blemb_int16_t _blemb_binary_read_unsafe_int16(blemb_byte_t * pointer, blemb_binary_endianness_t endianness) {
+    blemb_byte_t integer[2];
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        integer[0] = pointer[1];
+        integer[1] = pointer[0];
+    } else {
+        integer[0] = pointer[0];
+        integer[1] = pointer[1];
+    }
+    
+    return *((blemb_int16_t *)integer);
+}
+static inline void _blemb_binary_write_unsafe_int16(blemb_byte_t * pointer, blemb_int16_t value, blemb_binary_endianness_t endianness) {
+    blemb_byte_t * integer = (blemb_byte_t *)&value;
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        pointer[0] = integer[1];
+        pointer[1] = integer[0];
+    } else {
+        pointer[0] = integer[0];
+        pointer[1] = integer[1];
+    }
+}
+
+static inline blemb_binary_result_t blemb_binary_read_int16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int16_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 2);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_int16(buf.data, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_int16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int16_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 2);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_int16(buf.data, value, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
 
+// ------
 // UINT16
-extern blemb_binary_result_t blemb_binary_read_uint16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint16_t * result);
-extern blemb_binary_result_t blemb_binary_write_uint16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint16_t value);
+// ------
+static inline blemb_uint16_t _blemb_binary_read_unsafe_uint16(blemb_byte_t * pointer, blemb_binary_endianness_t endianness) {
+    blemb_byte_t integer[2];
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        integer[0] = pointer[1];
+        integer[1] = pointer[0];
+    } else {
+        integer[0] = pointer[0];
+        integer[1] = pointer[1];
+    }
+    
+    return *((blemb_uint16_t *)integer);
+}
+static inline void _blemb_binary_write_unsafe_uint16(blemb_byte_t * pointer, blemb_uint16_t value, blemb_binary_endianness_t endianness) {
+    blemb_byte_t * integer = (blemb_byte_t *)&value;
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        pointer[0] = integer[1];
+        pointer[1] = integer[0];
+    } else {
+        pointer[0] = integer[0];
+        pointer[1] = integer[1];
+    }
+}
 
+static inline blemb_binary_result_t blemb_binary_read_uint16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint16_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 2);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_uint16(buf.data, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_uint16(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint16_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 2);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_uint16(buf.data, value, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+
+// -----
 // INT32
-extern blemb_binary_result_t blemb_binary_read_int32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int32_t * result);
-extern blemb_binary_result_t blemb_binary_write_int32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int32_t value);
+// -----
+static inline blemb_int32_t _blemb_binary_read_unsafe_int32(blemb_byte_t * pointer, blemb_binary_endianness_t endianness) {
+    blemb_byte_t integer[4];
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        integer[0] = pointer[3];
+        integer[1] = pointer[2];
+        integer[2] = pointer[1];
+        integer[3] = pointer[0];
+    } else {
+        integer[0] = pointer[0];
+        integer[1] = pointer[1];
+        integer[2] = pointer[2];
+        integer[3] = pointer[3];
+    }
+    
+    return *((blemb_int32_t *)integer);
+}
+static inline void _blemb_binary_write_unsafe_int32(blemb_byte_t * pointer, blemb_int32_t value, blemb_binary_endianness_t endianness) {
+    blemb_byte_t * integer = (blemb_byte_t *)&value;
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        pointer[0] = integer[3];
+        pointer[1] = integer[2];
+        pointer[2] = integer[1];
+        pointer[3] = integer[0];
+    } else {
+        pointer[0] = integer[0];
+        pointer[1] = integer[1];
+        pointer[2] = integer[2];
+        pointer[3] = integer[3];
+    }
+}
+
+static inline blemb_binary_result_t blemb_binary_read_int32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int32_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 4);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_int32(buf.data, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_int32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_int32_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 4);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_int32(buf.data, value, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
 
+// ------
 // UINT32
-extern blemb_binary_result_t blemb_binary_read_uint32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint32_t * result);
-extern blemb_binary_result_t blemb_binary_write_uint32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint32_t value);
+// ------
+static inline blemb_uint32_t _blemb_binary_read_unsafe_uint32(blemb_byte_t * pointer, blemb_binary_endianness_t endianness) {
+    blemb_byte_t integer[4];
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        integer[0] = pointer[3];
+        integer[1] = pointer[2];
+        integer[2] = pointer[1];
+        integer[3] = pointer[0];
+    } else {
+        integer[0] = pointer[0];
+        integer[1] = pointer[1];
+        integer[2] = pointer[2];
+        integer[3] = pointer[3];
+    }
+    
+    return *((blemb_uint32_t *)integer);
+}
+static inline void _blemb_binary_write_unsafe_uint32(blemb_byte_t * pointer, blemb_uint32_t value, blemb_binary_endianness_t endianness) {
+    blemb_byte_t * integer = (blemb_byte_t *)&value;
+    
+    if (_blemb_binary_should_rotate(endianness) == BLEMB_TRUE) {
+        pointer[0] = integer[3];
+        pointer[1] = integer[2];
+        pointer[2] = integer[1];
+        pointer[3] = integer[0];
+    } else {
+        pointer[0] = integer[0];
+        pointer[1] = integer[1];
+        pointer[2] = integer[2];
+        pointer[3] = integer[3];
+    }
+}
+
+static inline blemb_binary_result_t blemb_binary_read_uint32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint32_t * result) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 4);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        *result = 0;
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    *result = _blemb_binary_read_unsafe_uint32(buf.data, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_uint32(blemb_buffer_t buffer, blemb_offset_t offset, blemb_binary_endianness_t endianness, blemb_uint32_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, 4);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    _blemb_binary_write_unsafe_uint32(buf.data, value, endianness);
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
 
+// ------
 // BUFFER
-extern blemb_binary_result_t blemb_binary_read_buffer(blemb_buffer_t buffer, blemb_offset_t offset, blemb_buffer_t * result);
-extern blemb_binary_result_t blemb_binary_write_buffer(blemb_buffer_t buffer, blemb_offset_t offset, blemb_buffer_t value);
+// ------
+static inline blemb_binary_result_t blemb_binary_read_buffer(blemb_buffer_t buffer, blemb_offset_t offset, blemb_buffer_t * result) {
+    if (result == NULL) return BLEMB_BINARY_RESULT_SUCCESS;
+    if (blemb_buffer_is_empty(*result) == BLEMB_TRUE) return BLEMB_BINARY_RESULT_SUCCESS;
+    
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, result->size);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    for (blemb_offset_t i = 0; i < result->size; i++) {
+        result->data[i] = buf.data[i];
+    }
+    
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
+static inline blemb_binary_result_t blemb_binary_write_buffer(blemb_buffer_t buffer, blemb_offset_t offset, blemb_buffer_t value) {
+    blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, value.size);
+    if (blemb_buffer_is_empty(buf) == BLEMB_TRUE) {
+        return BLEMB_BINARY_RESULT_FAILED_NOT_ENOUGH_BYTES;
+    }
+    
+    for (blemb_offset_t i = 0; i < buf.size; i++) {
+        buf.data[i] = value.data[i];
+    }
+    
+    return BLEMB_BINARY_RESULT_SUCCESS;
+}
 
 #endif
@@ -10,7 +10,25 @@
 
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/crc8.h>
+
+// CRC8 kernels. The one used by `blemb_crc8_update` is chosen at compile time
+// through `BLEMB_CRC8_KERNEL` (see the `BLEMB_PROTO_CRC8_KERNEL` CMake option).
+// BITWISE: no tables, 8 shift/xor steps per byte.
+// TABLE: 256 byte table, one lookup per byte.
+// SLICING4 / SLICING8: 1 KB / 2 KB of tables, 4 / 8 bytes folded per iteration.
+#define BLEMB_CRC8_KERNEL_BITWISE 0
+#define BLEMB_CRC8_KERNEL_TABLE 1
+#define BLEMB_CRC8_KERNEL_SLICING4 2
+#define BLEMB_CRC8_KERNEL_SLICING8 3
+
+#ifndef BLEMB_CRC8_KERNEL
+#define BLEMB_CRC8_KERNEL BLEMB_CRC8_KERNEL_TABLE
+#endif
 
 extern blemb_byte_t blemb_crc8_compute(blemb_buffer_t buffer);
 
+// Reference implementation, always available regardless of the selected kernel.
+extern blemb_byte_t blemb_crc8_update_bitwise(blemb_byte_t crc, blemb_buffer_t buffer);
+
 #endif
@@ -0,0 +1,185 @@
+//
+//  blemb_frame.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PRIVATE_FRAME_H
+#define BLEMB_PRIVATE_FRAME_H
+
+#include <blemb/types.h>
+#include <blemb/frame.h>
+#include <blemb_buffer.h>
+#include <blemb_crc8.h>
+#include <blemb_gf256.h>
+
+// Largest header of any format: magic (1) + 4 LEB128 bytes + header check (1).
+#define BLEMB_FRAME_HEADER_MAX_SIZE 6
+#define BLEMB_FRAME_TRAILER_SIZE 1
+
+// Result of decoding a header.
+typedef blemb_uint8_t blemb_frame_result_t;
+#define BLEMB_FRAME_RESULT_COMPLETE 0
+#define BLEMB_FRAME_RESULT_INCOMPLETE 1     // More bytes are needed.
+#define BLEMB_FRAME_RESULT_INVALID 2        // Not a header of this format.
+
+// Every optional flag of a format.
+#define BLEMB_FRAME_FLAGS (BLEMB_FRAME_FLAG_HEADER_CHECK | BLEMB_FRAME_FLAG_COMPRESSION)
+
+static inline blemb_bool_t blemb_frame_is_v2(blemb_frame_format_t format) {
+    return (format & ~BLEMB_FRAME_FLAGS) == BLEMB_FRAME_FORMAT_V2 ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+static inline blemb_size_t blemb_frame_check_size(blemb_frame_format_t format) {
+    return (format & BLEMB_FRAME_FLAG_HEADER_CHECK) != 0 ? 1 : 0;
+}
+
+// Size of the encoding byte that starts every payload of a compressed format.
+static inline blemb_size_t blemb_frame_encoding_size(blemb_frame_format_t format) {
+    return (format & BLEMB_FRAME_FLAG_COMPRESSION) != 0 ? 1 : 0;
+}
+
+static inline blemb_bool_t blemb_frame_is_valid(blemb_frame_format_t format) {
+    blemb_frame_format_t version = format & ~BLEMB_FRAME_FLAGS;
+    return version == BLEMB_FRAME_FORMAT_V1 || version == BLEMB_FRAME_FORMAT_V2 ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+static inline blemb_size_t blemb_frame_header_size(blemb_frame_format_t format, blemb_size_t payload_size) {
+    if (blemb_frame_is_v2(format) == BLEMB_FALSE) return 3 + blemb_frame_check_size(format);
+    
+    blemb_size_t size = 2 + blemb_frame_check_size(format);
+    while (payload_size >= 0x80) {
+        payload_size >>= 7;
+        size++;
+    }
+    return size;
+}
+
+// Smallest number of bytes that can hold a header, the magic byte included.
+static inline blemb_size_t blemb_frame_header_min_size(blemb_frame_format_t format) {
+    return blemb_frame_header_size(format, 0);
+}
+
+static inline blemb_size_t blemb_frame_max_payload_size(blemb_frame_format_t format) {
+    return blemb_frame_is_v2(format) == BLEMB_TRUE ? BLEMB_FRAME_V2_MAX_PAYLOAD_SIZE : BLEMB_FRAME_V1_MAX_PAYLOAD_SIZE;
+}
+
+// Writes the header of a message into `header` (`BLEMB_FRAME_HEADER_MAX_SIZE` bytes)
+// and returns its size. `payload_size` must not exceed the format's maximum.
+static inline blemb_size_t blemb_frame_write_header(blemb_frame_format_t format, blemb_byte_t magic, blemb_size_t payload_size, blemb_byte_t * header) {
+    header[0] = magic;
+    
+    blemb_size_t size = 1;
+    if (blemb_frame_is_v2(format) == BLEMB_FALSE) {
+        header[size++] = (blemb_byte_t)(payload_size >> 8);
+        header[size++] = (blemb_byte_t)payload_size;
+    } else {
+        while (payload_size >= 0x80) {
+            header[size++] = (blemb_byte_t)(payload_size | 0x80);
+            payload_size >>= 7;
+        }
+        header[size++] = (blemb_byte_t)payload_size;
+    }
+    
+    if (blemb_frame_check_size(format) > 0) {
+        header[size] = blemb_crc8_compute(blemb_buffer_init(header, size));
+        size++;
+    }
+    return size;
+}
+
+// Decodes the magic and size bytes of a header, and returns where they end in `size_end`.
+static inline blemb_frame_result_t _blemb_frame_read_size(blemb_frame_format_t format, const blemb_byte_t * data, blemb_size_t size, blemb_size_t * payload_size, blemb_size_t * size_end) {
+    if (blemb_frame_is_v2(format) == BLEMB_FALSE) {
+        if (size < 3) return BLEMB_FRAME_RESULT_INCOMPLETE;
+        
+        *payload_size = ((blemb_size_t)data[1] << 8) | data[2];
+        *size_end = 3;
+        return BLEMB_FRAME_RESULT_COMPLETE;
+    }
+    
+    blemb_size_t value = 0;
+    for (blemb_size_t i = 1; i < 5; i++) {
+        if (i >= size) return BLEMB_FRAME_RESULT_INCOMPLETE;
+        
+        value |= (blemb_size_t)(data[i] & 0x7F) << (7 * (i - 1));
+        if ((data[i] & 0x80) == 0) {
+            // A trailing zero byte means the size was not encoded with the fewest bytes.
+            if (i > 1 && data[i] == 0) return BLEMB_FRAME_RESULT_INVALID;
+            
+            *payload_size = value;
+            *size_end = i + 1;
+            return BLEMB_FRAME_RESULT_COMPLETE;
+        }
+    }
+    
+    return BLEMB_FRAME_RESULT_INVALID;
+}
+
+// Decodes the header at the start of `data` (`size` bytes available, magic byte included).
+static inline blemb_frame_result_t blemb_frame_read_header(blemb_frame_format_t format, const blemb_byte_t * data, blemb_size_t size, blemb_size_t * payload_size, blemb_size_t * header_size) {
+    blemb_size_t size_end = 0;
+    blemb_frame_result_t result = _blemb_frame_read_size(format, data, size, payload_size, &size_end);
+    if (result != BLEMB_FRAME_RESULT_COMPLETE) return result;
+    
+    if (blemb_frame_check_size(format) > 0) {
+        if (size_end >= size) return BLEMB_FRAME_RESULT_INCOMPLETE;
+        if (data[size_end] != blemb_crc8_compute(blemb_buffer_init((blemb_byte_t *)data, size_end))) return BLEMB_FRAME_RESULT_INVALID;
+        size_end++;
+    }
+    
+    *header_size = size_end;
+    return BLEMB_FRAME_RESULT_COMPLETE;
+}
+
+// -----------
+// FRAGMENTING
+// -----------
+#define BLEMB_FRAME_FRAGMENT_HEADER_SIZE 3
+#define BLEMB_FRAME_PARITY_HEADER_SIZE 4
+#define BLEMB_FRAME_FRAGMENT_LAST 0x8000
+#define BLEMB_FRAME_FRAGMENT_PARITY 0x4000
+#define BLEMB_FRAME_FRAGMENT_INDEX_MASK 0x3FFF
+
+// Writes the sequence and index of a fragment into `header` (`BLEMB_FRAME_FRAGMENT_HEADER_SIZE`
+// bytes). `flags` is zero or a combination of `BLEMB_FRAME_FRAGMENT_LAST` and `_PARITY`.
+static inline void blemb_frame_write_fragment_header(blemb_uint8_t sequence, blemb_uint16_t index, blemb_uint16_t flags, blemb_byte_t * header) {
+    index |= flags;
+    
+    header[0] = sequence;
+    header[1] = (blemb_byte_t)(index >> 8);
+    header[2] = (blemb_byte_t)index;
+}
+
+// Writes the header of parity fragment `index` into `header` (`BLEMB_FRAME_PARITY_HEADER_SIZE`
+// bytes): a fragment header and the count of data fragments in its group.
+static inline void blemb_frame_write_parity_header(blemb_uint8_t sequence, blemb_uint16_t index, blemb_uint8_t data_count, blemb_byte_t * header) {
+    blemb_frame_write_fragment_header(sequence, index, BLEMB_FRAME_FRAGMENT_PARITY, header);
+    header[BLEMB_FRAME_FRAGMENT_HEADER_SIZE] = data_count;
+}
+
+// Checks a whole fragment packet and decodes its header. `BLEMB_FRAME_RESULT_INVALID`
+// when it is too short or its checksum is wrong.
+static inline blemb_frame_result_t blemb_frame_read_fragment(blemb_buffer_t packet, blemb_uint8_t * sequence, blemb_uint16_t * index, blemb_uint16_t * flags) {
+    if (packet.size < BLEMB_FRAME_FRAGMENT_OVERHEAD + 1) return BLEMB_FRAME_RESULT_INVALID;
+    if (packet.data[packet.size - 1] != blemb_crc8_compute(blemb_buffer_init(packet.data, packet.size - 1))) return BLEMB_FRAME_RESULT_INVALID;
+    
+    blemb_uint16_t value = (blemb_uint16_t)(((blemb_uint16_t)packet.data[1] << 8) | packet.data[2]);
+    
+    *sequence = packet.data[0];
+    *index = value & BLEMB_FRAME_FRAGMENT_INDEX_MASK;
+    *flags = value & ~BLEMB_FRAME_FRAGMENT_INDEX_MASK;
+    return BLEMB_FRAME_RESULT_COMPLETE;
+}
+
+// Weight of data fragment `column` of a group in parity row `row` (see `blemb/frame.h`).
+// `data_count + BLEMB_FRAME_FEC_MAX_PARITY_COUNT` must not exceed 256.
+static inline blemb_byte_t blemb_frame_parity_coefficient(blemb_size_t data_count, blemb_size_t row, blemb_size_t column) {
+    if (row == 0) return 1;
+    
+    blemb_byte_t numerator = (blemb_byte_t)(data_count ^ column);
+    return blemb_gf256_mul(numerator, blemb_gf256_inv((blemb_byte_t)((data_count + row) ^ column)));
+}
+
+#endif
@@ -0,0 +1,38 @@
+//
+//  blemb_gf256.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PRIVATE_GF256_H
+#define BLEMB_PRIVATE_GF256_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+
+// Arithmetic in GF(2^8) (polynom 0x11D), used by the parity fragments of `protow` and
+// `protoh`. Addition is a xor. The kernel used by `blemb_gf256_mul_add` is chosen at
+// compile time through `BLEMB_GF256_KERNEL` (see the `BLEMB_PROTO_GF256_KERNEL` CMake option).
+// NIBBLE: no tables. Two 16 byte tables are built per call, one lookup per nibble, or one
+//         shuffle per 16 bytes when the compiler targets SSSE3 or NEON.
+// TABLE: 768 bytes of log/exp tables, one product per byte.
+#define BLEMB_GF256_KERNEL_NIBBLE 0
+#define BLEMB_GF256_KERNEL_TABLE 1
+
+#ifndef BLEMB_GF256_KERNEL
+#define BLEMB_GF256_KERNEL BLEMB_GF256_KERNEL_NIBBLE
+#endif
+
+extern blemb_byte_t blemb_gf256_mul(blemb_byte_t a, blemb_byte_t b);
+
+// `a` must not be zero.
+extern blemb_byte_t blemb_gf256_inv(blemb_byte_t a);
+
+// `target[i] ^= coefficient * source[i]` for `size` bytes.
+extern void blemb_gf256_mul_add(blemb_byte_t * target, const blemb_byte_t * source, blemb_byte_t coefficient, blemb_size_t size);
+
+// Reference implementation, always available regardless of the selected kernel.
+extern void blemb_gf256_mul_add_bitwise(blemb_byte_t * target, const blemb_byte_t * source, blemb_byte_t coefficient, blemb_size_t size);
+
+#endif
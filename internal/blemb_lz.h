@@ -0,0 +1,36 @@
+//
+//  blemb_lz.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PRIVATE_LZ_H
+#define BLEMB_PRIVATE_LZ_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/lz.h>
+
+// Streaming decoder. Decoded bytes go to `window`, a ring of `window_size` bytes. With at
+// least `BLEMB_LZ_WINDOW_SIZE` bytes they can be handed out as they come and the ring
+// reused (see `blemb_lz_decoder_take`); a window they are never taken from holds the
+// whole output, which then must fit in it.
+extern void blemb_lz_decoder_init(blemb_lz_decoder_t * decoder, blemb_buffer_t dictionary, blemb_byte_t * window, blemb_size_t window_size);
+
+// Decodes `input` until it is used up or the window is full of bytes not taken yet, and
+// returns the number of bytes taken from it. Malformed input is taken whole.
+extern blemb_size_t blemb_lz_decode(blemb_lz_decoder_t * decoder, blemb_buffer_t input);
+
+// Hands out the bytes decoded since the last call, as two consecutive pieces of the
+// window: `second` is only non-empty when they wrap around its end.
+extern void blemb_lz_decoder_take(blemb_lz_decoder_t * decoder, blemb_buffer_t * first, blemb_buffer_t * second);
+
+// `BLEMB_FALSE` once malformed input was found.
+extern blemb_bool_t blemb_lz_decoder_is_valid(blemb_lz_decoder_t * decoder);
+
+// `BLEMB_TRUE` when the input so far is well formed and ends between two sequences,
+// so it may be the whole data.
+extern blemb_bool_t blemb_lz_decoder_is_complete(blemb_lz_decoder_t * decoder);
+
+#endif
@@ -0,0 +1,35 @@
+//
+//  blemb_scan.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PRIVATE_SCAN_H
+#define BLEMB_PRIVATE_SCAN_H
+
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+
+// Byte scanning kernels, selected at compile time from the target flags:
+// AVX2 (32 bytes per step, needs `-mavx2`), SSE2 (16 bytes, always on x86-64),
+// NEON (16 bytes) or a portable SWAR fallback (8 bytes).
+#if defined(__AVX2__)
+#define BLEMB_SCAN_KERNEL_NAME "avx2"
+#elif defined(__SSE2__)
+#define BLEMB_SCAN_KERNEL_NAME "sse2"
+#elif defined(__ARM_NEON)
+#define BLEMB_SCAN_KERNEL_NAME "neon"
+#else
+#define BLEMB_SCAN_KERNEL_NAME "swar"
+#endif
+
+// Returns the offset of the first `value` at or after `offset`, or `buffer.size` if there is none.
+extern blemb_offset_t blemb_scan_find_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value);
+
+// Stores, in ascending order, the offsets of up to `max_count` occurrences of `value`
+// at or after `offset`, and returns how many were stored. `next_offset` receives the
+// offset to resume the scan from (`buffer.size` when the whole buffer was scanned).
+extern blemb_size_t blemb_scan_find_all(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value, blemb_offset_t * result, blemb_size_t max_count, blemb_offset_t * next_offset);
+
+#endif
@@ -0,0 +1,21 @@
+//
+//  blemb_stats.h
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#ifndef BLEMB_PRIVATE_STATS_H
+#define BLEMB_PRIVATE_STATS_H
+
+#include <stddef.h>
+
+// Counters are only compiled in when the library is built with `BLEMB_STATS`
+// (CMake option `BLEMB_PROTO_STATS`). Otherwise every update is an empty statement.
+#if defined(BLEMB_STATS) && BLEMB_STATS
+#define BLEMB_STATS_ADD(stats, counter, value) do { if ((stats) != NULL) (stats)->counter += (value); } while (0)
+#else
+#define BLEMB_STATS_ADD(stats, counter, value) do { (void)(stats); } while (0)
+#endif
+
+#endif
@@ -10,52 +10,282 @@
 // PUBLIC
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/crc8.h>
 
 // PRIVATE
+#include <blemb_buffer.h>
 #include <blemb_crc8.h>
 
-blemb_byte_t _blemb_reverse_bits(blemb_byte_t byte) {
-    blemb_byte_t result = 0;
-    for (blemb_uint32_t i = 0; i < 8; i++) {
-        result <<= 1;             // Shift result left
-        result |= (byte & 1);     // Copy least significant bit of byte
-        byte >>= 1;               // Shift byte right
-    }
-    return result;
-}
+// Configured to use Bluetooth CRC8: polynom 0xA7, no reflection, no final xor.
+#define _BLEMB_CRC8_POLYNOM 0xA7
+#define _BLEMB_CRC8_INITIAL 0x00
+#define _BLEMB_CRC8_XOR 0x00
 
-blemb_byte_t blemb_crc8_compute(blemb_buffer_t buffer) {
-    // Configured to use Bluetooth CRC8.
-    blemb_uint8_t initial_crc = 0x00;
-    blemb_uint8_t polynom = 0xA7;
-    blemb_uint8_t xor = 0x00;
-    blemb_bool_t ref_in = BLEMB_FALSE;
-    blemb_bool_t ref_out = BLEMB_FALSE;
-    
-    blemb_byte_t crc = initial_crc;
-    
+// Number of lookup tables needed by the selected kernel. Table `k` holds the CRC of
+// a byte followed by `k` zero bytes, so several input bytes can be folded at once.
+#if BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_SLICING8
+#define _BLEMB_CRC8_TABLE_COUNT 8
+#elif BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_SLICING4
+#define _BLEMB_CRC8_TABLE_COUNT 4
+#elif BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_TABLE
+#define _BLEMB_CRC8_TABLE_COUNT 1
+#else
+#define _BLEMB_CRC8_TABLE_COUNT 0
+#endif
+
+#if _BLEMB_CRC8_TABLE_COUNT > 0
+static const blemb_byte_t _blemb_crc8_table[_BLEMB_CRC8_TABLE_COUNT][256] = {
+    {
+        0x00, 0xA7, 0xE9, 0x4E, 0x75, 0xD2, 0x9C, 0x3B, 0xEA, 0x4D, 0x03, 0xA4, 0x9F, 0x38, 0x76, 0xD1,
+        0x73, 0xD4, 0x9A, 0x3D, 0x06, 0xA1, 0xEF, 0x48, 0x99, 0x3E, 0x70, 0xD7, 0xEC, 0x4B, 0x05, 0xA2,
+        0xE6, 0x41, 0x0F, 0xA8, 0x93, 0x34, 0x7A, 0xDD, 0x0C, 0xAB, 0xE5, 0x42, 0x79, 0xDE, 0x90, 0x37,
+        0x95, 0x32, 0x7C, 0xDB, 0xE0, 0x47, 0x09, 0xAE, 0x7F, 0xD8, 0x96, 0x31, 0x0A, 0xAD, 0xE3, 0x44,
+        0x6B, 0xCC, 0x82, 0x25, 0x1E, 0xB9, 0xF7, 0x50, 0x81, 0x26, 0x68, 0xCF, 0xF4, 0x53, 0x1D, 0xBA,
+        0x18, 0xBF, 0xF1, 0x56, 0x6D, 0xCA, 0x84, 0x23, 0xF2, 0x55, 0x1B, 0xBC, 0x87, 0x20, 0x6E, 0xC9,
+        0x8D, 0x2A, 0x64, 0xC3, 0xF8, 0x5F, 0x11, 0xB6, 0x67, 0xC0, 0x8E, 0x29, 0x12, 0xB5, 0xFB, 0x5C,
+        0xFE, 0x59, 0x17, 0xB0, 0x8B, 0x2C, 0x62, 0xC5, 0x14, 0xB3, 0xFD, 0x5A, 0x61, 0xC6, 0x88, 0x2F,
+        0xD6, 0x71, 0x3F, 0x98, 0xA3, 0x04, 0x4A, 0xED, 0x3C, 0x9B, 0xD5, 0x72, 0x49, 0xEE, 0xA0, 0x07,
+        0xA5, 0x02, 0x4C, 0xEB, 0xD0, 0x77, 0x39, 0x9E, 0x4F, 0xE8, 0xA6, 0x01, 0x3A, 0x9D, 0xD3, 0x74,
+        0x30, 0x97, 0xD9, 0x7E, 0x45, 0xE2, 0xAC, 0x0B, 0xDA, 0x7D, 0x33, 0x94, 0xAF, 0x08, 0x46, 0xE1,
+        0x43, 0xE4, 0xAA, 0x0D, 0x36, 0x91, 0xDF, 0x78, 0xA9, 0x0E, 0x40, 0xE7, 0xDC, 0x7B, 0x35, 0x92,
+        0xBD, 0x1A, 0x54, 0xF3, 0xC8, 0x6F, 0x21, 0x86, 0x57, 0xF0, 0xBE, 0x19, 0x22, 0x85, 0xCB, 0x6C,
+        0xCE, 0x69, 0x27, 0x80, 0xBB, 0x1C, 0x52, 0xF5, 0x24, 0x83, 0xCD, 0x6A, 0x51, 0xF6, 0xB8, 0x1F,
+        0x5B, 0xFC, 0xB2, 0x15, 0x2E, 0x89, 0xC7, 0x60, 0xB1, 0x16, 0x58, 0xFF, 0xC4, 0x63, 0x2D, 0x8A,
+        0x28, 0x8F, 0xC1, 0x66, 0x5D, 0xFA, 0xB4, 0x13, 0xC2, 0x65, 0x2B, 0x8C, 0xB7, 0x10, 0x5E, 0xF9,
+    },
+#if _BLEMB_CRC8_TABLE_COUNT > 1
+
+    {
+        0x00, 0x0B, 0x16, 0x1D, 0x2C, 0x27, 0x3A, 0x31, 0x58, 0x53, 0x4E, 0x45, 0x74, 0x7F, 0x62, 0x69,
+        0xB0, 0xBB, 0xA6, 0xAD, 0x9C, 0x97, 0x8A, 0x81, 0xE8, 0xE3, 0xFE, 0xF5, 0xC4, 0xCF, 0xD2, 0xD9,
+        0xC7, 0xCC, 0xD1, 0xDA, 0xEB, 0xE0, 0xFD, 0xF6, 0x9F, 0x94, 0x89, 0x82, 0xB3, 0xB8, 0xA5, 0xAE,
+        0x77, 0x7C, 0x61, 0x6A, 0x5B, 0x50, 0x4D, 0x46, 0x2F, 0x24, 0x39, 0x32, 0x03, 0x08, 0x15, 0x1E,
+        0x29, 0x22, 0x3F, 0x34, 0x05, 0x0E, 0x13, 0x18, 0x71, 0x7A, 0x67, 0x6C, 0x5D, 0x56, 0x4B, 0x40,
+        0x99, 0x92, 0x8F, 0x84, 0xB5, 0xBE, 0xA3, 0xA8, 0xC1, 0xCA, 0xD7, 0xDC, 0xED, 0xE6, 0xFB, 0xF0,
+        0xEE, 0xE5, 0xF8, 0xF3, 0xC2, 0xC9, 0xD4, 0xDF, 0xB6, 0xBD, 0xA0, 0xAB, 0x9A, 0x91, 0x8C, 0x87,
+        0x5E, 0x55, 0x48, 0x43, 0x72, 0x79, 0x64, 0x6F, 0x06, 0x0D, 0x10, 0x1B, 0x2A, 0x21, 0x3C, 0x37,
+        0x52, 0x59, 0x44, 0x4F, 0x7E, 0x75, 0x68, 0x63, 0x0A, 0x01, 0x1C, 0x17, 0x26, 0x2D, 0x30, 0x3B,
+        0xE2, 0xE9, 0xF4, 0xFF, 0xCE, 0xC5, 0xD8, 0xD3, 0xBA, 0xB1, 0xAC, 0xA7, 0x96, 0x9D, 0x80, 0x8B,
+        0x95, 0x9E, 0x83, 0x88, 0xB9, 0xB2, 0xAF, 0xA4, 0xCD, 0xC6, 0xDB, 0xD0, 0xE1, 0xEA, 0xF7, 0xFC,
+        0x25, 0x2E, 0x33, 0x38, 0x09, 0x02, 0x1F, 0x14, 0x7D, 0x76, 0x6B, 0x60, 0x51, 0x5A, 0x47, 0x4C,
+        0x7B, 0x70, 0x6D, 0x66, 0x57, 0x5C, 0x41, 0x4A, 0x23, 0x28, 0x35, 0x3E, 0x0F, 0x04, 0x19, 0x12,
+        0xCB, 0xC0, 0xDD, 0xD6, 0xE7, 0xEC, 0xF1, 0xFA, 0x93, 0x98, 0x85, 0x8E, 0xBF, 0xB4, 0xA9, 0xA2,
+        0xBC, 0xB7, 0xAA, 0xA1, 0x90, 0x9B, 0x86, 0x8D, 0xE4, 0xEF, 0xF2, 0xF9, 0xC8, 0xC3, 0xDE, 0xD5,
+        0x0C, 0x07, 0x1A, 0x11, 0x20, 0x2B, 0x36, 0x3D, 0x54, 0x5F, 0x42, 0x49, 0x78, 0x73, 0x6E, 0x65,
+    },
+
+    {
+        0x00, 0xA4, 0xEF, 0x4B, 0x79, 0xDD, 0x96, 0x32, 0xF2, 0x56, 0x1D, 0xB9, 0x8B, 0x2F, 0x64, 0xC0,
+        0x43, 0xE7, 0xAC, 0x08, 0x3A, 0x9E, 0xD5, 0x71, 0xB1, 0x15, 0x5E, 0xFA, 0xC8, 0x6C, 0x27, 0x83,
+        0x86, 0x22, 0x69, 0xCD, 0xFF, 0x5B, 0x10, 0xB4, 0x74, 0xD0, 0x9B, 0x3F, 0x0D, 0xA9, 0xE2, 0x46,
+        0xC5, 0x61, 0x2A, 0x8E, 0xBC, 0x18, 0x53, 0xF7, 0x37, 0x93, 0xD8, 0x7C, 0x4E, 0xEA, 0xA1, 0x05,
+        0xAB, 0x0F, 0x44, 0xE0, 0xD2, 0x76, 0x3D, 0x99, 0x59, 0xFD, 0xB6, 0x12, 0x20, 0x84, 0xCF, 0x6B,
+        0xE8, 0x4C, 0x07, 0xA3, 0x91, 0x35, 0x7E, 0xDA, 0x1A, 0xBE, 0xF5, 0x51, 0x63, 0xC7, 0x8C, 0x28,
+        0x2D, 0x89, 0xC2, 0x66, 0x54, 0xF0, 0xBB, 0x1F, 0xDF, 0x7B, 0x30, 0x94, 0xA6, 0x02, 0x49, 0xED,
+        0x6E, 0xCA, 0x81, 0x25, 0x17, 0xB3, 0xF8, 0x5C, 0x9C, 0x38, 0x73, 0xD7, 0xE5, 0x41, 0x0A, 0xAE,
+        0xF1, 0x55, 0x1E, 0xBA, 0x88, 0x2C, 0x67, 0xC3, 0x03, 0xA7, 0xEC, 0x48, 0x7A, 0xDE, 0x95, 0x31,
+        0xB2, 0x16, 0x5D, 0xF9, 0xCB, 0x6F, 0x24, 0x80, 0x40, 0xE4, 0xAF, 0x0B, 0x39, 0x9D, 0xD6, 0x72,
+        0x77, 0xD3, 0x98, 0x3C, 0x0E, 0xAA, 0xE1, 0x45, 0x85, 0x21, 0x6A, 0xCE, 0xFC, 0x58, 0x13, 0xB7,
+        0x34, 0x90, 0xDB, 0x7F, 0x4D, 0xE9, 0xA2, 0x06, 0xC6, 0x62, 0x29, 0x8D, 0xBF, 0x1B, 0x50, 0xF4,
+        0x5A, 0xFE, 0xB5, 0x11, 0x23, 0x87, 0xCC, 0x68, 0xA8, 0x0C, 0x47, 0xE3, 0xD1, 0x75, 0x3E, 0x9A,
+        0x19, 0xBD, 0xF6, 0x52, 0x60, 0xC4, 0x8F, 0x2B, 0xEB, 0x4F, 0x04, 0xA0, 0x92, 0x36, 0x7D, 0xD9,
+        0xDC, 0x78, 0x33, 0x97, 0xA5, 0x01, 0x4A, 0xEE, 0x2E, 0x8A, 0xC1, 0x65, 0x57, 0xF3, 0xB8, 0x1C,
+        0x9F, 0x3B, 0x70, 0xD4, 0xE6, 0x42, 0x09, 0xAD, 0x6D, 0xC9, 0x82, 0x26, 0x14, 0xB0, 0xFB, 0x5F,
+    },
+
+    {
+        0x00, 0x45, 0x8A, 0xCF, 0xB3, 0xF6, 0x39, 0x7C, 0xC1, 0x84, 0x4B, 0x0E, 0x72, 0x37, 0xF8, 0xBD,
+        0x25, 0x60, 0xAF, 0xEA, 0x96, 0xD3, 0x1C, 0x59, 0xE4, 0xA1, 0x6E, 0x2B, 0x57, 0x12, 0xDD, 0x98,
+        0x4A, 0x0F, 0xC0, 0x85, 0xF9, 0xBC, 0x73, 0x36, 0x8B, 0xCE, 0x01, 0x44, 0x38, 0x7D, 0xB2, 0xF7,
+        0x6F, 0x2A, 0xE5, 0xA0, 0xDC, 0x99, 0x56, 0x13, 0xAE, 0xEB, 0x24, 0x61, 0x1D, 0x58, 0x97, 0xD2,
+        0x94, 0xD1, 0x1E, 0x5B, 0x27, 0x62, 0xAD, 0xE8, 0x55, 0x10, 0xDF, 0x9A, 0xE6, 0xA3, 0x6C, 0x29,
+        0xB1, 0xF4, 0x3B, 0x7E, 0x02, 0x47, 0x88, 0xCD, 0x70, 0x35, 0xFA, 0xBF, 0xC3, 0x86, 0x49, 0x0C,
+        0xDE, 0x9B, 0x54, 0x11, 0x6D, 0x28, 0xE7, 0xA2, 0x1F, 0x5A, 0x95, 0xD0, 0xAC, 0xE9, 0x26, 0x63,
+        0xFB, 0xBE, 0x71, 0x34, 0x48, 0x0D, 0xC2, 0x87, 0x3A, 0x7F, 0xB0, 0xF5, 0x89, 0xCC, 0x03, 0x46,
+        0x8F, 0xCA, 0x05, 0x40, 0x3C, 0x79, 0xB6, 0xF3, 0x4E, 0x0B, 0xC4, 0x81, 0xFD, 0xB8, 0x77, 0x32,
+        0xAA, 0xEF, 0x20, 0x65, 0x19, 0x5C, 0x93, 0xD6, 0x6B, 0x2E, 0xE1, 0xA4, 0xD8, 0x9D, 0x52, 0x17,
+        0xC5, 0x80, 0x4F, 0x0A, 0x76, 0x33, 0xFC, 0xB9, 0x04, 0x41, 0x8E, 0xCB, 0xB7, 0xF2, 0x3D, 0x78,
+        0xE0, 0xA5, 0x6A, 0x2F, 0x53, 0x16, 0xD9, 0x9C, 0x21, 0x64, 0xAB, 0xEE, 0x92, 0xD7, 0x18, 0x5D,
+        0x1B, 0x5E, 0x91, 0xD4, 0xA8, 0xED, 0x22, 0x67, 0xDA, 0x9F, 0x50, 0x15, 0x69, 0x2C, 0xE3, 0xA6,
+        0x3E, 0x7B, 0xB4, 0xF1, 0x8D, 0xC8, 0x07, 0x42, 0xFF, 0xBA, 0x75, 0x30, 0x4C, 0x09, 0xC6, 0x83,
+        0x51, 0x14, 0xDB, 0x9E, 0xE2, 0xA7, 0x68, 0x2D, 0x90, 0xD5, 0x1A, 0x5F, 0x23, 0x66, 0xA9, 0xEC,
+        0x74, 0x31, 0xFE, 0xBB, 0xC7, 0x82, 0x4D, 0x08, 0xB5, 0xF0, 0x3F, 0x7A, 0x06, 0x43, 0x8C, 0xC9,
+    },
+#endif
+#if _BLEMB_CRC8_TABLE_COUNT > 4
+
+    {
+        0x00, 0xB9, 0xD5, 0x6C, 0x0D, 0xB4, 0xD8, 0x61, 0x1A, 0xA3, 0xCF, 0x76, 0x17, 0xAE, 0xC2, 0x7B,
+        0x34, 0x8D, 0xE1, 0x58, 0x39, 0x80, 0xEC, 0x55, 0x2E, 0x97, 0xFB, 0x42, 0x23, 0x9A, 0xF6, 0x4F,
+        0x68, 0xD1, 0xBD, 0x04, 0x65, 0xDC, 0xB0, 0x09, 0x72, 0xCB, 0xA7, 0x1E, 0x7F, 0xC6, 0xAA, 0x13,
+        0x5C, 0xE5, 0x89, 0x30, 0x51, 0xE8, 0x84, 0x3D, 0x46, 0xFF, 0x93, 0x2A, 0x4B, 0xF2, 0x9E, 0x27,
+        0xD0, 0x69, 0x05, 0xBC, 0xDD, 0x64, 0x08, 0xB1, 0xCA, 0x73, 0x1F, 0xA6, 0xC7, 0x7E, 0x12, 0xAB,
+        0xE4, 0x5D, 0x31, 0x88, 0xE9, 0x50, 0x3C, 0x85, 0xFE, 0x47, 0x2B, 0x92, 0xF3, 0x4A, 0x26, 0x9F,
+        0xB8, 0x01, 0x6D, 0xD4, 0xB5, 0x0C, 0x60, 0xD9, 0xA2, 0x1B, 0x77, 0xCE, 0xAF, 0x16, 0x7A, 0xC3,
+        0x8C, 0x35, 0x59, 0xE0, 0x81, 0x38, 0x54, 0xED, 0x96, 0x2F, 0x43, 0xFA, 0x9B, 0x22, 0x4E, 0xF7,
+        0x07, 0xBE, 0xD2, 0x6B, 0x0A, 0xB3, 0xDF, 0x66, 0x1D, 0xA4, 0xC8, 0x71, 0x10, 0xA9, 0xC5, 0x7C,
+        0x33, 0x8A, 0xE6, 0x5F, 0x3E, 0x87, 0xEB, 0x52, 0x29, 0x90, 0xFC, 0x45, 0x24, 0x9D, 0xF1, 0x48,
+        0x6F, 0xD6, 0xBA, 0x03, 0x62, 0xDB, 0xB7, 0x0E, 0x75, 0xCC, 0xA0, 0x19, 0x78, 0xC1, 0xAD, 0x14,
+        0x5B, 0xE2, 0x8E, 0x37, 0x56, 0xEF, 0x83, 0x3A, 0x41, 0xF8, 0x94, 0x2D, 0x4C, 0xF5, 0x99, 0x20,
+        0xD7, 0x6E, 0x02, 0xBB, 0xDA, 0x63, 0x0F, 0xB6, 0xCD, 0x74, 0x18, 0xA1, 0xC0, 0x79, 0x15, 0xAC,
+        0xE3, 0x5A, 0x36, 0x8F, 0xEE, 0x57, 0x3B, 0x82, 0xF9, 0x40, 0x2C, 0x95, 0xF4, 0x4D, 0x21, 0x98,
+        0xBF, 0x06, 0x6A, 0xD3, 0xB2, 0x0B, 0x67, 0xDE, 0xA5, 0x1C, 0x70, 0xC9, 0xA8, 0x11, 0x7D, 0xC4,
+        0x8B, 0x32, 0x5E, 0xE7, 0x86, 0x3F, 0x53, 0xEA, 0x91, 0x28, 0x44, 0xFD, 0x9C, 0x25, 0x49, 0xF0,
+    },
+
+    {
+        0x00, 0x0E, 0x1C, 0x12, 0x38, 0x36, 0x24, 0x2A, 0x70, 0x7E, 0x6C, 0x62, 0x48, 0x46, 0x54, 0x5A,
+        0xE0, 0xEE, 0xFC, 0xF2, 0xD8, 0xD6, 0xC4, 0xCA, 0x90, 0x9E, 0x8C, 0x82, 0xA8, 0xA6, 0xB4, 0xBA,
+        0x67, 0x69, 0x7B, 0x75, 0x5F, 0x51, 0x43, 0x4D, 0x17, 0x19, 0x0B, 0x05, 0x2F, 0x21, 0x33, 0x3D,
+        0x87, 0x89, 0x9B, 0x95, 0xBF, 0xB1, 0xA3, 0xAD, 0xF7, 0xF9, 0xEB, 0xE5, 0xCF, 0xC1, 0xD3, 0xDD,
+        0xCE, 0xC0, 0xD2, 0xDC, 0xF6, 0xF8, 0xEA, 0xE4, 0xBE, 0xB0, 0xA2, 0xAC, 0x86, 0x88, 0x9A, 0x94,
+        0x2E, 0x20, 0x32, 0x3C, 0x16, 0x18, 0x0A, 0x04, 0x5E, 0x50, 0x42, 0x4C, 0x66, 0x68, 0x7A, 0x74,
+        0xA9, 0xA7, 0xB5, 0xBB, 0x91, 0x9F, 0x8D, 0x83, 0xD9, 0xD7, 0xC5, 0xCB, 0xE1, 0xEF, 0xFD, 0xF3,
+        0x49, 0x47, 0x55, 0x5B, 0x71, 0x7F, 0x6D, 0x63, 0x39, 0x37, 0x25, 0x2B, 0x01, 0x0F, 0x1D, 0x13,
+        0x3B, 0x35, 0x27, 0x29, 0x03, 0x0D, 0x1F, 0x11, 0x4B, 0x45, 0x57, 0x59, 0x73, 0x7D, 0x6F, 0x61,
+        0xDB, 0xD5, 0xC7, 0xC9, 0xE3, 0xED, 0xFF, 0xF1, 0xAB, 0xA5, 0xB7, 0xB9, 0x93, 0x9D, 0x8F, 0x81,
+        0x5C, 0x52, 0x40, 0x4E, 0x64, 0x6A, 0x78, 0x76, 0x2C, 0x22, 0x30, 0x3E, 0x14, 0x1A, 0x08, 0x06,
+        0xBC, 0xB2, 0xA0, 0xAE, 0x84, 0x8A, 0x98, 0x96, 0xCC, 0xC2, 0xD0, 0xDE, 0xF4, 0xFA, 0xE8, 0xE6,
+        0xF5, 0xFB, 0xE9, 0xE7, 0xCD, 0xC3, 0xD1, 0xDF, 0x85, 0x8B, 0x99, 0x97, 0xBD, 0xB3, 0xA1, 0xAF,
+        0x15, 0x1B, 0x09, 0x07, 0x2D, 0x23, 0x31, 0x3F, 0x65, 0x6B, 0x79, 0x77, 0x5D, 0x53, 0x41, 0x4F,
+        0x92, 0x9C, 0x8E, 0x80, 0xAA, 0xA4, 0xB6, 0xB8, 0xE2, 0xEC, 0xFE, 0xF0, 0xDA, 0xD4, 0xC6, 0xC8,
+        0x72, 0x7C, 0x6E, 0x60, 0x4A, 0x44, 0x56, 0x58, 0x02, 0x0C, 0x1E, 0x10, 0x3A, 0x34, 0x26, 0x28,
+    },
+
+    {
+        0x00, 0x76, 0xEC, 0x9A, 0x7F, 0x09, 0x93, 0xE5, 0xFE, 0x88, 0x12, 0x64, 0x81, 0xF7, 0x6D, 0x1B,
+        0x5B, 0x2D, 0xB7, 0xC1, 0x24, 0x52, 0xC8, 0xBE, 0xA5, 0xD3, 0x49, 0x3F, 0xDA, 0xAC, 0x36, 0x40,
+        0xB6, 0xC0, 0x5A, 0x2C, 0xC9, 0xBF, 0x25, 0x53, 0x48, 0x3E, 0xA4, 0xD2, 0x37, 0x41, 0xDB, 0xAD,
+        0xED, 0x9B, 0x01, 0x77, 0x92, 0xE4, 0x7E, 0x08, 0x13, 0x65, 0xFF, 0x89, 0x6C, 0x1A, 0x80, 0xF6,
+        0xCB, 0xBD, 0x27, 0x51, 0xB4, 0xC2, 0x58, 0x2E, 0x35, 0x43, 0xD9, 0xAF, 0x4A, 0x3C, 0xA6, 0xD0,
+        0x90, 0xE6, 0x7C, 0x0A, 0xEF, 0x99, 0x03, 0x75, 0x6E, 0x18, 0x82, 0xF4, 0x11, 0x67, 0xFD, 0x8B,
+        0x7D, 0x0B, 0x91, 0xE7, 0x02, 0x74, 0xEE, 0x98, 0x83, 0xF5, 0x6F, 0x19, 0xFC, 0x8A, 0x10, 0x66,
+        0x26, 0x50, 0xCA, 0xBC, 0x59, 0x2F, 0xB5, 0xC3, 0xD8, 0xAE, 0x34, 0x42, 0xA7, 0xD1, 0x4B, 0x3D,
+        0x31, 0x47, 0xDD, 0xAB, 0x4E, 0x38, 0xA2, 0xD4, 0xCF, 0xB9, 0x23, 0x55, 0xB0, 0xC6, 0x5C, 0x2A,
+        0x6A, 0x1C, 0x86, 0xF0, 0x15, 0x63, 0xF9, 0x8F, 0x94, 0xE2, 0x78, 0x0E, 0xEB, 0x9D, 0x07, 0x71,
+        0x87, 0xF1, 0x6B, 0x1D, 0xF8, 0x8E, 0x14, 0x62, 0x79, 0x0F, 0x95, 0xE3, 0x06, 0x70, 0xEA, 0x9C,
+        0xDC, 0xAA, 0x30, 0x46, 0xA3, 0xD5, 0x4F, 0x39, 0x22, 0x54, 0xCE, 0xB8, 0x5D, 0x2B, 0xB1, 0xC7,
+        0xFA, 0x8C, 0x16, 0x60, 0x85, 0xF3, 0x69, 0x1F, 0x04, 0x72, 0xE8, 0x9E, 0x7B, 0x0D, 0x97, 0xE1,
+        0xA1, 0xD7, 0x4D, 0x3B, 0xDE, 0xA8, 0x32, 0x44, 0x5F, 0x29, 0xB3, 0xC5, 0x20, 0x56, 0xCC, 0xBA,
+        0x4C, 0x3A, 0xA0, 0xD6, 0x33, 0x45, 0xDF, 0xA9, 0xB2, 0xC4, 0x5E, 0x28, 0xCD, 0xBB, 0x21, 0x57,
+        0x17, 0x61, 0xFB, 0x8D, 0x68, 0x1E, 0x84, 0xF2, 0xE9, 0x9F, 0x05, 0x73, 0x96, 0xE0, 0x7A, 0x0C,
+    },
+
+    {
+        0x00, 0x62, 0xC4, 0xA6, 0x2F, 0x4D, 0xEB, 0x89, 0x5E, 0x3C, 0x9A, 0xF8, 0x71, 0x13, 0xB5, 0xD7,
+        0xBC, 0xDE, 0x78, 0x1A, 0x93, 0xF1, 0x57, 0x35, 0xE2, 0x80, 0x26, 0x44, 0xCD, 0xAF, 0x09, 0x6B,
+        0xDF, 0xBD, 0x1B, 0x79, 0xF0, 0x92, 0x34, 0x56, 0x81, 0xE3, 0x45, 0x27, 0xAE, 0xCC, 0x6A, 0x08,
+        0x63, 0x01, 0xA7, 0xC5, 0x4C, 0x2E, 0x88, 0xEA, 0x3D, 0x5F, 0xF9, 0x9B, 0x12, 0x70, 0xD6, 0xB4,
+        0x19, 0x7B, 0xDD, 0xBF, 0x36, 0x54, 0xF2, 0x90, 0x47, 0x25, 0x83, 0xE1, 0x68, 0x0A, 0xAC, 0xCE,
+        0xA5, 0xC7, 0x61, 0x03, 0x8A, 0xE8, 0x4E, 0x2C, 0xFB, 0x99, 0x3F, 0x5D, 0xD4, 0xB6, 0x10, 0x72,
+        0xC6, 0xA4, 0x02, 0x60, 0xE9, 0x8B, 0x2D, 0x4F, 0x98, 0xFA, 0x5C, 0x3E, 0xB7, 0xD5, 0x73, 0x11,
+        0x7A, 0x18, 0xBE, 0xDC, 0x55, 0x37, 0x91, 0xF3, 0x24, 0x46, 0xE0, 0x82, 0x0B, 0x69, 0xCF, 0xAD,
+        0x32, 0x50, 0xF6, 0x94, 0x1D, 0x7F, 0xD9, 0xBB, 0x6C, 0x0E, 0xA8, 0xCA, 0x43, 0x21, 0x87, 0xE5,
+        0x8E, 0xEC, 0x4A, 0x28, 0xA1, 0xC3, 0x65, 0x07, 0xD0, 0xB2, 0x14, 0x76, 0xFF, 0x9D, 0x3B, 0x59,
+        0xED, 0x8F, 0x29, 0x4B, 0xC2, 0xA0, 0x06, 0x64, 0xB3, 0xD1, 0x77, 0x15, 0x9C, 0xFE, 0x58, 0x3A,
+        0x51, 0x33, 0x95, 0xF7, 0x7E, 0x1C, 0xBA, 0xD8, 0x0F, 0x6D, 0xCB, 0xA9, 0x20, 0x42, 0xE4, 0x86,
+        0x2B, 0x49, 0xEF, 0x8D, 0x04, 0x66, 0xC0, 0xA2, 0x75, 0x17, 0xB1, 0xD3, 0x5A, 0x38, 0x9E, 0xFC,
+        0x97, 0xF5, 0x53, 0x31, 0xB8, 0xDA, 0x7C, 0x1E, 0xC9, 0xAB, 0x0D, 0x6F, 0xE6, 0x84, 0x22, 0x40,
+        0xF4, 0x96, 0x30, 0x52, 0xDB, 0xB9, 0x1F, 0x7D, 0xAA, 0xC8, 0x6E, 0x0C, 0x85, 0xE7, 0x41, 0x23,
+        0x48, 0x2A, 0x8C, 0xEE, 0x67, 0x05, 0xA3, 0xC1, 0x16, 0x74, 0xD2, 0xB0, 0x39, 0x5B, 0xFD, 0x9F,
+    },
+#endif
+};
+#endif
+
+// -------
+// KERNELS
+// -------
+blemb_byte_t blemb_crc8_update_bitwise(blemb_byte_t crc, blemb_buffer_t buffer) {
     for (blemb_offset_t i = 0; i < buffer.size; i++) {
-        blemb_byte_t byte = buffer.data[i];
-        
-        if (ref_in == BLEMB_TRUE) {
-            crc ^= _blemb_reverse_bits(byte);
-        } else {
-            crc ^= byte;
-        }
+        crc ^= buffer.data[i];
         
         for (blemb_offset_t j = 0; j < 8; j++) {
             blemb_byte_t check = crc & 0x80;
             crc <<= 1;
             
             if (check != 0) {
-                crc ^= polynom;
+                crc ^= _BLEMB_CRC8_POLYNOM;
             }
         }
     }
+    
+    return crc;
+}
+
+#if _BLEMB_CRC8_TABLE_COUNT > 0
+blemb_byte_t _blemb_crc8_update_table(blemb_byte_t crc, const blemb_byte_t * data, blemb_size_t size) {
+    for (blemb_offset_t i = 0; i < size; i++) {
+        crc = _blemb_crc8_table[0][crc ^ data[i]];
+    }
+    
+    return crc;
+}
+#endif
+
+#if _BLEMB_CRC8_TABLE_COUNT >= 4
+blemb_byte_t _blemb_crc8_update_slicing4(blemb_byte_t crc, const blemb_byte_t * data, blemb_size_t size) {
+    // The CRC is linear, so the contribution of each byte of the block can be
+    // looked up independently and combined with a xor.
+    while (size >= 4) {
+        crc = _blemb_crc8_table[3][crc ^ data[0]] ^
+              _blemb_crc8_table[2][data[1]] ^
+              _blemb_crc8_table[1][data[2]] ^
+              _blemb_crc8_table[0][data[3]];
+        
+        data += 4;
+        size -= 4;
+    }
+    
+    return _blemb_crc8_update_table(crc, data, size);
+}
+#endif
+
+#if _BLEMB_CRC8_TABLE_COUNT >= 8
+blemb_byte_t _blemb_crc8_update_slicing8(blemb_byte_t crc, const blemb_byte_t * data, blemb_size_t size) {
+    while (size >= 8) {
+        crc = _blemb_crc8_table[7][crc ^ data[0]] ^
+              _blemb_crc8_table[6][data[1]] ^
+              _blemb_crc8_table[5][data[2]] ^
+              _blemb_crc8_table[4][data[3]] ^
+              _blemb_crc8_table[3][data[4]] ^
+              _blemb_crc8_table[2][data[5]] ^
+              _blemb_crc8_table[1][data[6]] ^
+              _blemb_crc8_table[0][data[7]];
         
-    if (ref_out == BLEMB_TRUE) {
-        return _blemb_reverse_bits(crc) ^ xor;
-    } else {
-        return crc ^ xor;
+        data += 8;
+        size -= 8;
     }
+    
+    return _blemb_crc8_update_slicing4(crc, data, size);
+}
+#endif
+
+// ------
+// PUBLIC
+// ------
+blemb_byte_t blemb_crc8_init(void) {
+    return _BLEMB_CRC8_INITIAL;
+}
+
+blemb_byte_t blemb_crc8_update(blemb_byte_t crc, blemb_buffer_t buffer) {
+    if (blemb_buffer_is_empty(buffer) == BLEMB_TRUE) return crc;
+    
+#if BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_SLICING8
+    return _blemb_crc8_update_slicing8(crc, buffer.data, buffer.size);
+#elif BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_SLICING4
+    return _blemb_crc8_update_slicing4(crc, buffer.data, buffer.size);
+#elif BLEMB_CRC8_KERNEL == BLEMB_CRC8_KERNEL_TABLE
+    return _blemb_crc8_update_table(crc, buffer.data, buffer.size);
+#else
+    return blemb_crc8_update_bitwise(crc, buffer);
+#endif
+}
+
+blemb_byte_t blemb_crc8_final(blemb_byte_t crc) {
+    return crc ^ _BLEMB_CRC8_XOR;
+}
+
+blemb_byte_t blemb_crc8_compute(blemb_buffer_t buffer) {
+    return blemb_crc8_final(blemb_crc8_update(blemb_crc8_init(), buffer));
 }
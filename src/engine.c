@@ -0,0 +1,251 @@
+//
+//  engine.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+// STDLIB
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// PUBLIC
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/protod.h>
+#include <blemb/engine.h>
+
+// PRIVATE
+#include <blemb_buffer.h>
+
+// Ring records: an 8 byte header (connection id, then `size << 2 | type`) followed by
+// `size` bytes of data, padded to 8 bytes. A record never wraps around the end of the
+// ring: when it does not fit, the producer fills the end with a padding record.
+#define _BLEMB_ENGINE_RECORD_HEADER_SIZE 8
+#define _BLEMB_ENGINE_RECORD_ALIGNMENT 8
+#define _BLEMB_ENGINE_RECORD_DATA 0
+#define _BLEMB_ENGINE_RECORD_CLOSE 1
+#define _BLEMB_ENGINE_RECORD_PADDING 2
+
+// Idle workers spin, then yield, then sleep for `_BLEMB_ENGINE_IDLE_SLEEP_NS`.
+#define _BLEMB_ENGINE_IDLE_SPINS 64
+#define _BLEMB_ENGINE_IDLE_YIELDS 128
+#define _BLEMB_ENGINE_IDLE_SLEEP_NS 50000
+
+blemb_uint32_t _blemb_engine_record_size(blemb_uint32_t data_size) {
+    return (_BLEMB_ENGINE_RECORD_HEADER_SIZE + data_size + _BLEMB_ENGINE_RECORD_ALIGNMENT - 1) & ~(blemb_uint32_t)(_BLEMB_ENGINE_RECORD_ALIGNMENT - 1);
+}
+
+void _blemb_engine_write_header(blemb_byte_t * record, blemb_uint32_t connection_id, blemb_uint32_t size, blemb_uint32_t type) {
+    blemb_uint32_t info = size << 2 | type;
+    
+    memcpy(record, &connection_id, sizeof(connection_id));
+    memcpy(record + sizeof(connection_id), &info, sizeof(info));
+}
+
+// --------
+// PRODUCER
+// --------
+blemb_bool_t _blemb_engine_push(blemb_engine_worker_t * worker, blemb_uint32_t connection_id, blemb_buffer_t data, blemb_uint32_t type) {
+    // Records larger than half the ring could wait forever for contiguous space.
+    if (data.size > worker->ring_size / 2 - _BLEMB_ENGINE_RECORD_HEADER_SIZE) return BLEMB_FALSE;
+    
+    blemb_uint32_t mask = worker->ring_size - 1;
+    blemb_uint32_t head = atomic_load_explicit(&worker->ring_head, memory_order_acquire);
+    blemb_uint32_t tail = atomic_load_explicit(&worker->ring_tail, memory_order_relaxed);
+    
+    blemb_uint32_t record_size = _blemb_engine_record_size(data.size);
+    blemb_uint32_t index = tail & mask;
+    blemb_uint32_t contiguous_size = worker->ring_size - index;
+    blemb_uint32_t padding_size = record_size > contiguous_size ? contiguous_size : 0;
+    
+    // Indices grow freely and wrap at 2^32: `tail - head` is always the used space.
+    if (tail - head + padding_size + record_size > worker->ring_size) return BLEMB_FALSE;
+    
+    if (padding_size > 0) {
+        _blemb_engine_write_header(worker->ring_data + index, 0, padding_size, _BLEMB_ENGINE_RECORD_PADDING);
+        tail += padding_size;
+        index = 0;
+    }
+    
+    _blemb_engine_write_header(worker->ring_data + index, connection_id, data.size, type);
+    if (data.size > 0) {
+        memcpy(worker->ring_data + index + _BLEMB_ENGINE_RECORD_HEADER_SIZE, data.data, data.size);
+    }
+    
+    // Publish the record: the consumer reads `ring_tail` with acquire semantics.
+    atomic_store_explicit(&worker->ring_tail, tail + record_size, memory_order_release);
+    
+    return BLEMB_TRUE;
+}
+
+// --------
+// CONSUMER
+// --------
+blemb_uint32_t _blemb_engine_drain(blemb_engine_worker_t * worker) {
+    blemb_uint32_t mask = worker->ring_size - 1;
+    blemb_uint32_t head = atomic_load_explicit(&worker->ring_head, memory_order_relaxed);
+    blemb_uint32_t tail = atomic_load_explicit(&worker->ring_tail, memory_order_acquire);
+    blemb_uint32_t count = 0;
+    
+    while (head != tail) {
+        blemb_byte_t * record = worker->ring_data + (head & mask);
+        
+        blemb_uint32_t connection_id = 0;
+        blemb_uint32_t info = 0;
+        memcpy(&connection_id, record, sizeof(connection_id));
+        memcpy(&info, record + sizeof(connection_id), sizeof(info));
+        
+        blemb_uint32_t type = info & 3;
+        blemb_uint32_t size = info >> 2;
+        
+        if (type == _BLEMB_ENGINE_RECORD_PADDING) {
+            head += size;
+        } else {
+            if (type == _BLEMB_ENGINE_RECORD_DATA) {
+                blemb_protod_handle(&worker->sessions, connection_id, blemb_buffer_init(record + _BLEMB_ENGINE_RECORD_HEADER_SIZE, size));
+            } else {
+                blemb_protod_close(&worker->sessions, connection_id);
+            }
+            
+            head += _blemb_engine_record_size(size);
+            count++;
+        }
+        
+        // Hand the space back to the producer as soon as the record is processed.
+        atomic_store_explicit(&worker->ring_head, head, memory_order_release);
+    }
+    
+    return count;
+}
+
+void _blemb_engine_idle(blemb_uint32_t round) {
+    if (round < _BLEMB_ENGINE_IDLE_SPINS) {
+        return;
+    }
+    if (round < _BLEMB_ENGINE_IDLE_YIELDS) {
+        sched_yield();
+        return;
+    }
+    
+    struct timespec delay = { .tv_sec = 0, .tv_nsec = _BLEMB_ENGINE_IDLE_SLEEP_NS };
+    nanosleep(&delay, NULL);
+}
+
+void * _blemb_engine_worker_main(void * argument) {
+    blemb_engine_worker_t * worker = (blemb_engine_worker_t *)argument;
+    blemb_uint32_t idle_rounds = 0;
+    
+    while (BLEMB_TRUE) {
+        if (_blemb_engine_drain(worker) > 0) {
+            idle_rounds = 0;
+            continue;
+        }
+        
+        // Everything submitted before `stopping` was set is visible now:
+        // drain one last time and leave.
+        if (atomic_load(&worker->stopping) == BLEMB_TRUE) {
+            _blemb_engine_drain(worker);
+            break;
+        }
+        
+        _blemb_engine_idle(idle_rounds);
+        if (idle_rounds < _BLEMB_ENGINE_IDLE_YIELDS) {
+            idle_rounds++;
+        }
+    }
+    
+    return NULL;
+}
+
+void _blemb_engine_pin(blemb_engine_worker_t * worker) {
+#if defined(__linux__)
+    if (worker->pin_cpu == BLEMB_FALSE) return;
+    
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(worker->cpu, &cpus);
+    pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus);
+#else
+    (void)worker;
+#endif
+}
+
+// ------
+// PUBLIC
+// ------
+blemb_uint32_t blemb_engine_worker_index(blemb_engine_t * engine, blemb_uint32_t connection_id) {
+    if (engine == NULL || engine->worker_count == 0) return 0;
+    
+    // Hash, then map to [0, worker_count) with a multiply-shift instead of a modulo.
+    blemb_uint32_t hash = connection_id * 2246822519u;
+    hash ^= hash >> 15;
+    
+    return (blemb_uint32_t)(((uint64_t)hash * engine->worker_count) >> 32);
+}
+
+blemb_bool_t blemb_engine_start(blemb_engine_t * engine) {
+    if (engine == NULL || engine->workers == NULL || engine->worker_count == 0) return BLEMB_FALSE;
+    
+    for (blemb_uint32_t i = 0; i < engine->worker_count; i++) {
+        blemb_engine_worker_t * worker = &engine->workers[i];
+        
+        if (worker->ring_data == NULL) return BLEMB_FALSE;
+        if (worker->ring_size < 64 || (worker->ring_size & (worker->ring_size - 1)) != 0) return BLEMB_FALSE;
+    }
+    
+    for (blemb_uint32_t i = 0; i < engine->worker_count; i++) {
+        blemb_engine_worker_t * worker = &engine->workers[i];
+        
+        atomic_init(&worker->ring_head, 0);
+        atomic_init(&worker->ring_tail, 0);
+        atomic_init(&worker->stopping, BLEMB_FALSE);
+        
+        if (pthread_create(&worker->thread, NULL, _blemb_engine_worker_main, worker) != 0) {
+            // Stop the workers that did start.
+            blemb_engine_t started = { .workers = engine->workers, .worker_count = i };
+            blemb_engine_stop(&started);
+            return BLEMB_FALSE;
+        }
+        
+        _blemb_engine_pin(worker);
+    }
+    
+    return BLEMB_TRUE;
+}
+
+void blemb_engine_stop(blemb_engine_t * engine) {
+    if (engine == NULL || engine->workers == NULL) return;
+    
+    for (blemb_uint32_t i = 0; i < engine->worker_count; i++) {
+        atomic_store(&engine->workers[i].stopping, BLEMB_TRUE);
+    }
+    for (blemb_uint32_t i = 0; i < engine->worker_count; i++) {
+        pthread_join(engine->workers[i].thread, NULL);
+    }
+}
+
+blemb_bool_t blemb_engine_submit(blemb_engine_t * engine, blemb_uint32_t connection_id, blemb_buffer_t data) {
+    if (engine == NULL || engine->workers == NULL || engine->worker_count == 0) return BLEMB_FALSE;
+    if (data.data == NULL && data.size > 0) return BLEMB_FALSE;
+    
+    blemb_engine_worker_t * worker = &engine->workers[blemb_engine_worker_index(engine, connection_id)];
+    
+    return _blemb_engine_push(worker, connection_id, data, _BLEMB_ENGINE_RECORD_DATA);
+}
+
+blemb_bool_t blemb_engine_close(blemb_engine_t * engine, blemb_uint32_t connection_id) {
+    if (engine == NULL || engine->workers == NULL || engine->worker_count == 0) return BLEMB_FALSE;
+    
+    blemb_engine_worker_t * worker = &engine->workers[blemb_engine_worker_index(engine, connection_id)];
+    
+    return _blemb_engine_push(worker, connection_id, blemb_buffer_empty(), _BLEMB_ENGINE_RECORD_CLOSE);
+}
@@ -0,0 +1,337 @@
+//
+//  lz.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// STDLIB
+#include <stddef.h>
+#include <string.h>
+
+// PUBLIC
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/lz.h>
+
+// PRIVATE
+#include <blemb_buffer.h>
+#include <blemb_lz.h>
+
+#define _BLEMB_LZ_LITERAL_MAX_RUN 128
+#define _BLEMB_LZ_COPY_LENGTH_BITS 15       // Largest length field of a copy: more length bytes follow.
+#define _BLEMB_LZ_HASH_BITS 8
+
+// -------
+// ENCODER
+// -------
+// Greedy parsing: at every position, the last one with the same next 3 bytes is tried,
+// through a hash table of 256 positions (only their low 16 bits: a wrong guess is
+// found out when comparing). The dictionary and the input are seen as one sequence,
+// positions in the dictionary coming first.
+typedef struct _blemb_lz_source_t {
+    const blemb_byte_t * dictionary;
+    blemb_size_t dictionary_size;
+    const blemb_byte_t * input;
+    blemb_size_t end;                       // Dictionary and input sizes.
+} _blemb_lz_source_t;
+
+blemb_byte_t _blemb_lz_at(const _blemb_lz_source_t * source, blemb_size_t position) {
+    return position < source->dictionary_size ? source->dictionary[position] : source->input[position - source->dictionary_size];
+}
+
+blemb_size_t _blemb_lz_hash(const _blemb_lz_source_t * source, blemb_size_t position) {
+    // Only called with 3 bytes left from `position`.
+    blemb_uint32_t value = ((blemb_uint32_t)_blemb_lz_at(source, position) << 16) | ((blemb_uint32_t)_blemb_lz_at(source, position + 1) << 8) | _blemb_lz_at(source, position + 2);
+    return (value * 2654435761u) >> (32 - _BLEMB_LZ_HASH_BITS);
+}
+
+blemb_bool_t _blemb_lz_emit_literals(const _blemb_lz_source_t * source, blemb_size_t from, blemb_size_t to, blemb_buffer_t output, blemb_size_t * output_size) {
+    while (from < to) {
+        blemb_size_t run = to - from;
+        if (run > _BLEMB_LZ_LITERAL_MAX_RUN) run = _BLEMB_LZ_LITERAL_MAX_RUN;
+        if (output.size - *output_size < run + 1) return BLEMB_FALSE;
+        
+        // Literals always come from the input, never from the dictionary.
+        output.data[(*output_size)++] = (blemb_byte_t)(run - 1);
+        memcpy(output.data + *output_size, source->input + (from - source->dictionary_size), run);
+        *output_size += run;
+        from += run;
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t _blemb_lz_emit_copy(blemb_size_t distance, blemb_size_t length, blemb_buffer_t output, blemb_size_t * output_size) {
+    blemb_size_t field = length - BLEMB_LZ_MIN_COPY;
+    if (field > _BLEMB_LZ_COPY_LENGTH_BITS) field = _BLEMB_LZ_COPY_LENGTH_BITS;
+    
+    blemb_size_t extra = 0;
+    if (field == _BLEMB_LZ_COPY_LENGTH_BITS) {
+        extra = (length - BLEMB_LZ_MIN_COPY - _BLEMB_LZ_COPY_LENGTH_BITS) / 255 + 1;
+    }
+    if (output.size - *output_size < 2 + extra) return BLEMB_FALSE;
+    
+    distance -= 1;
+    output.data[(*output_size)++] = (blemb_byte_t)(0x80 | (field << 3) | (distance >> 8));
+    output.data[(*output_size)++] = (blemb_byte_t)distance;
+    
+    if (field == _BLEMB_LZ_COPY_LENGTH_BITS) {
+        blemb_size_t rest = length - BLEMB_LZ_MIN_COPY - _BLEMB_LZ_COPY_LENGTH_BITS;
+        while (rest >= 255) {
+            output.data[(*output_size)++] = 255;
+            rest -= 255;
+        }
+        output.data[(*output_size)++] = (blemb_byte_t)rest;
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_lz_compress(blemb_buffer_t dictionary, blemb_buffer_t input, blemb_buffer_t output, blemb_size_t * output_size) {
+    if (output_size == NULL) return BLEMB_FALSE;
+    *output_size = 0;
+    
+    if (input.data == NULL && input.size > 0) return BLEMB_FALSE;
+    if (output.data == NULL && output.size > 0) return BLEMB_FALSE;
+    
+    // Only the end of the dictionary is within reach.
+    if (dictionary.data == NULL) dictionary.size = 0;
+    if (dictionary.size > BLEMB_LZ_WINDOW_SIZE) {
+        dictionary.data += dictionary.size - BLEMB_LZ_WINDOW_SIZE;
+        dictionary.size = BLEMB_LZ_WINDOW_SIZE;
+    }
+    
+    _blemb_lz_source_t source = { .dictionary = dictionary.data, .dictionary_size = dictionary.size, .input = input.data, .end = dictionary.size + input.size };
+    
+    blemb_uint16_t table[1 << _BLEMB_LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+    
+    for (blemb_size_t position = 0; position + BLEMB_LZ_MIN_COPY <= dictionary.size; position++) {
+        table[_blemb_lz_hash(&source, position)] = (blemb_uint16_t)position;
+    }
+    
+    blemb_size_t size = 0;
+    blemb_size_t position = dictionary.size;
+    blemb_size_t literals = position;
+    while (position + BLEMB_LZ_MIN_COPY <= source.end) {
+        blemb_size_t hash = _blemb_lz_hash(&source, position);
+        blemb_size_t distance = (blemb_uint16_t)(position - table[hash]);
+        table[hash] = (blemb_uint16_t)position;
+        
+        blemb_size_t length = 0;
+        if (distance >= 1 && distance <= BLEMB_LZ_WINDOW_SIZE && distance <= position) {
+            while (position + length < source.end && _blemb_lz_at(&source, position + length - distance) == _blemb_lz_at(&source, position + length)) {
+                length++;
+            }
+        }
+        
+        if (length < BLEMB_LZ_MIN_COPY) {
+            position++;
+            continue;
+        }
+        
+        if (_blemb_lz_emit_literals(&source, literals, position, output, &size) == BLEMB_FALSE) return BLEMB_FALSE;
+        if (_blemb_lz_emit_copy(distance, length, output, &size) == BLEMB_FALSE) return BLEMB_FALSE;
+        
+        // The positions inside the copy are remembered too, for later copies.
+        for (blemb_size_t i = 1; i < length && position + i + BLEMB_LZ_MIN_COPY <= source.end; i++) {
+            table[_blemb_lz_hash(&source, position + i)] = (blemb_uint16_t)(position + i);
+        }
+        
+        position += length;
+        literals = position;
+    }
+    
+    if (_blemb_lz_emit_literals(&source, literals, source.end, output, &size) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    *output_size = size;
+    return BLEMB_TRUE;
+}
+
+// -------
+// DECODER
+// -------
+// A state machine, so input can stop anywhere: in a literal run, between the two bytes
+// of a copy, or in its length bytes.
+#define _BLEMB_LZ_STATE_TOKEN 0
+#define _BLEMB_LZ_STATE_LITERALS 1
+#define _BLEMB_LZ_STATE_DISTANCE 2
+#define _BLEMB_LZ_STATE_LENGTH 3
+#define _BLEMB_LZ_STATE_COPY 4
+#define _BLEMB_LZ_STATE_ERROR 5
+
+// Longer copies are malformed: no message decodes to this much.
+#define _BLEMB_LZ_COPY_MAX_LENGTH 0x0FFFFFFF
+
+void blemb_lz_decoder_init(blemb_lz_decoder_t * decoder, blemb_buffer_t dictionary, blemb_byte_t * window, blemb_size_t window_size) {
+    memset(decoder, 0, sizeof(*decoder));
+    
+    // Only the end of the dictionary is within reach.
+    if (dictionary.data == NULL) dictionary.size = 0;
+    if (dictionary.size > BLEMB_LZ_WINDOW_SIZE) {
+        dictionary.data += dictionary.size - BLEMB_LZ_WINDOW_SIZE;
+        dictionary.size = BLEMB_LZ_WINDOW_SIZE;
+    }
+    
+    decoder->dictionary = dictionary.data;
+    decoder->dictionary_size = dictionary.size;
+    decoder->window = window;
+    decoder->window_size = window != NULL ? window_size : 0;
+    decoder->state = _BLEMB_LZ_STATE_TOKEN;
+}
+
+void _blemb_lz_decoder_put(blemb_lz_decoder_t * decoder, const blemb_byte_t * data, blemb_size_t size) {
+    // `size` never exceeds the room left in the window.
+    decoder->produced += size;
+    decoder->pending += size;
+    
+    while (size > 0) {
+        blemb_size_t part = decoder->window_size - decoder->window_head;
+        if (part > size) part = size;
+        
+        memcpy(decoder->window + decoder->window_head, data, part);
+        decoder->window_head += part;
+        if (decoder->window_head == decoder->window_size) decoder->window_head = 0;
+        
+        data += part;
+        size -= part;
+    }
+}
+
+void _blemb_lz_decoder_copy(blemb_lz_decoder_t * decoder, blemb_size_t size) {
+    // One byte at a time: a copy may overlap the bytes it produces.
+    for (blemb_size_t i = 0; i < size; i++) {
+        blemb_size_t distance = decoder->distance;
+        blemb_byte_t byte;
+        if (distance > decoder->produced) {
+            byte = decoder->dictionary[decoder->dictionary_size - (distance - decoder->produced)];
+        } else {
+            blemb_size_t index = decoder->window_head >= distance ? decoder->window_head - distance : decoder->window_head + decoder->window_size - distance;
+            byte = decoder->window[index];
+        }
+        
+        decoder->window[decoder->window_head] = byte;
+        decoder->window_head++;
+        if (decoder->window_head == decoder->window_size) decoder->window_head = 0;
+        decoder->produced++;
+        decoder->pending++;
+    }
+}
+
+blemb_size_t blemb_lz_decode(blemb_lz_decoder_t * decoder, blemb_buffer_t input) {
+    blemb_offset_t offset = 0;
+    
+    for (;;) {
+        blemb_size_t room = decoder->window_size - decoder->pending;
+        
+        switch (decoder->state) {
+            case _BLEMB_LZ_STATE_TOKEN: {
+                if (offset == input.size) return offset;
+                
+                blemb_byte_t token = input.data[offset++];
+                if ((token & 0x80) == 0) {
+                    decoder->length = (blemb_size_t)token + 1;
+                    decoder->state = _BLEMB_LZ_STATE_LITERALS;
+                } else {
+                    // The length field waits in `length`, the top distance bits in `distance`.
+                    decoder->length = (token >> 3) & _BLEMB_LZ_COPY_LENGTH_BITS;
+                    decoder->distance = token & 0x07;
+                    decoder->state = _BLEMB_LZ_STATE_DISTANCE;
+                }
+                break;
+            }
+            case _BLEMB_LZ_STATE_LITERALS: {
+                blemb_size_t size = decoder->length;
+                if (size > input.size - offset) size = input.size - offset;
+                if (size > room) size = room;
+                if (size == 0) return offset;
+                
+                _blemb_lz_decoder_put(decoder, input.data + offset, size);
+                offset += size;
+                decoder->length -= size;
+                if (decoder->length == 0) decoder->state = _BLEMB_LZ_STATE_TOKEN;
+                break;
+            }
+            case _BLEMB_LZ_STATE_DISTANCE: {
+                if (offset == input.size) return offset;
+                
+                blemb_size_t distance = (((blemb_size_t)decoder->distance << 8) | input.data[offset++]) + 1;
+                
+                // Bytes before the data come from the dictionary, and those in the window
+                // must not have been overwritten yet.
+                if (distance > decoder->produced + decoder->dictionary_size || (distance <= decoder->produced && distance > decoder->window_size)) {
+                    decoder->state = _BLEMB_LZ_STATE_ERROR;
+                    return input.size;
+                }
+                
+                decoder->distance = (blemb_uint16_t)distance;
+                decoder->state = decoder->length == _BLEMB_LZ_COPY_LENGTH_BITS ? _BLEMB_LZ_STATE_LENGTH : _BLEMB_LZ_STATE_COPY;
+                decoder->length += BLEMB_LZ_MIN_COPY;
+                break;
+            }
+            case _BLEMB_LZ_STATE_LENGTH: {
+                if (offset == input.size) return offset;
+                
+                blemb_byte_t byte = input.data[offset++];
+                decoder->length += byte;
+                if (decoder->length > _BLEMB_LZ_COPY_MAX_LENGTH) {
+                    decoder->state = _BLEMB_LZ_STATE_ERROR;
+                    return input.size;
+                }
+                if (byte < 255) decoder->state = _BLEMB_LZ_STATE_COPY;
+                break;
+            }
+            case _BLEMB_LZ_STATE_COPY: {
+                blemb_size_t size = decoder->length;
+                if (size > room) size = room;
+                if (size == 0) return offset;
+                
+                _blemb_lz_decoder_copy(decoder, size);
+                decoder->length -= size;
+                if (decoder->length == 0) decoder->state = _BLEMB_LZ_STATE_TOKEN;
+                break;
+            }
+            default:
+                return input.size;
+        }
+    }
+}
+
+void blemb_lz_decoder_take(blemb_lz_decoder_t * decoder, blemb_buffer_t * first, blemb_buffer_t * second) {
+    // The pending bytes end where the next decoded byte goes.
+    blemb_size_t size = decoder->pending;
+    blemb_size_t start = decoder->window_head >= size ? decoder->window_head - size : decoder->window_head + decoder->window_size - size;
+    
+    blemb_size_t first_size = decoder->window_size - start;
+    if (first_size > size) first_size = size;
+    
+    *first = blemb_buffer_init(decoder->window + start, first_size);
+    *second = blemb_buffer_init(decoder->window, size - first_size);
+    decoder->pending = 0;
+}
+
+blemb_bool_t blemb_lz_decoder_is_valid(blemb_lz_decoder_t * decoder) {
+    return decoder->state != _BLEMB_LZ_STATE_ERROR ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_bool_t blemb_lz_decoder_is_complete(blemb_lz_decoder_t * decoder) {
+    return decoder->state == _BLEMB_LZ_STATE_TOKEN ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_bool_t blemb_lz_decompress(blemb_buffer_t dictionary, blemb_buffer_t input, blemb_buffer_t output, blemb_size_t * output_size) {
+    if (output_size == NULL) return BLEMB_FALSE;
+    *output_size = 0;
+    
+    if (input.data == NULL && input.size > 0) return BLEMB_FALSE;
+    
+    // Nothing is ever taken, so the window holds the whole output.
+    blemb_lz_decoder_t decoder;
+    blemb_lz_decoder_init(&decoder, dictionary, output.data, output.size);
+    
+    if (blemb_lz_decode(&decoder, input) < input.size) return BLEMB_FALSE;
+    if (blemb_lz_decoder_is_complete(&decoder) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    *output_size = decoder.produced;
+    return BLEMB_TRUE;
+}
@@ -0,0 +1,62 @@
+//
+//  pool.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// STDLIB
+#include <stddef.h>
+#include <string.h>
+
+// PUBLIC
+#include <blemb/types.h>
+#include <blemb/pool.h>
+
+// Released blocks form a free list. Each one stores, in its first 4 bytes, the
+// index (plus one) of the next released block; `free_head` is 0 when the list is
+// empty. Blocks never handed out are taken in order from `next_unused`, so a
+// zero-initialized pool needs no setup.
+#define _BLEMB_POOL_LINK_SIZE 4
+
+blemb_byte_t * blemb_pool_alloc(blemb_pool_t * pool) {
+    if (pool == NULL || pool->data == NULL) return NULL;
+    if (pool->block_size < _BLEMB_POOL_LINK_SIZE) return NULL;
+    
+    if (pool->free_head > 0) {
+        blemb_byte_t * block = pool->data + (pool->free_head - 1) * pool->block_size;
+        
+        blemb_uint32_t next = 0;
+        memcpy(&next, block, sizeof(next));
+        
+        pool->free_head = next;
+        pool->used_count++;
+        return block;
+    }
+    
+    if (pool->next_unused < pool->block_count) {
+        blemb_byte_t * block = pool->data + pool->next_unused * pool->block_size;
+        
+        pool->next_unused++;
+        pool->used_count++;
+        return block;
+    }
+    
+    return NULL;
+}
+
+void blemb_pool_free(blemb_pool_t * pool, blemb_byte_t * block) {
+    if (pool == NULL || pool->data == NULL || block == NULL) return;
+    
+    // Ignore pointers that are not blocks of this pool.
+    if (block < pool->data) return;
+    blemb_size_t offset = (blemb_size_t)(block - pool->data);
+    if (offset % pool->block_size != 0) return;
+    if (offset / pool->block_size >= pool->next_unused) return;
+    
+    blemb_uint32_t next = pool->free_head;
+    memcpy(block, &next, sizeof(next));
+    
+    pool->free_head = offset / pool->block_size + 1;
+    pool->used_count--;
+}
@@ -0,0 +1,159 @@
+//
+//  protod.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// STDLIB
+#include <stddef.h>
+#include <string.h>
+
+// PUBLIC
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+#include <blemb/pool.h>
+#include <blemb/protoh.h>
+#include <blemb/protod.h>
+
+// PRIVATE
+#include <blemb_buffer.h>
+#include <blemb_scan.h>
+#include <blemb_stats.h>
+
+// The session table is an open addressing hash table with linear probing.
+// Closed sessions are removed with backward shifting, so no tombstones are needed.
+blemb_uint32_t _blemb_protod_home_slot(blemb_protod_context_t * context, blemb_uint32_t connection_id) {
+    // Multiplicative hashing spreads sequential connection identifiers.
+    return (blemb_uint32_t)((connection_id * 2654435761u) % context->session_max_count);
+}
+
+blemb_protod_session_t * _blemb_protod_find_session(blemb_protod_context_t * context, blemb_uint32_t connection_id, blemb_bool_t create) {
+    blemb_uint32_t slot = _blemb_protod_home_slot(context, connection_id);
+    
+    for (blemb_uint32_t probe = 0; probe < context->session_max_count; probe++) {
+        blemb_protod_session_t * session = &context->sessions[slot];
+        
+        if (session->used == BLEMB_FALSE) {
+            if (create == BLEMB_FALSE) return NULL;
+            
+            memset(session, 0, sizeof(*session));
+            session->used = BLEMB_TRUE;
+            session->connection_id = connection_id;
+            return session;
+        }
+        if (session->connection_id == connection_id) {
+            return session;
+        }
+        
+        slot = slot + 1 < context->session_max_count ? slot + 1 : 0;
+    }
+    
+    return NULL;
+}
+
+void _blemb_protod_deliver(blemb_protoh_context_t * parser, blemb_buffer_t message, blemb_buffer_t message_tail) {
+    blemb_protod_context_t * context = (blemb_protod_context_t *)parser->user_data;
+    blemb_protod_session_t * session = (blemb_protod_session_t *)((blemb_byte_t *)parser - offsetof(blemb_protod_session_t, parser));
+    
+    // Session buffers are linear, so `message_tail` is always empty.
+    (void)message_tail;
+    
+    if (context->handler != NULL) {
+        context->handler(context, session->connection_id, message);
+    }
+}
+
+void _blemb_protod_release_buffer(blemb_protod_context_t * context, blemb_protod_session_t * session) {
+    if (session->parser.buffer_data == NULL) return;
+    
+    blemb_pool_free(&context->pool, session->parser.buffer_data);
+    session->parser.buffer_data = NULL;
+    session->parser.buffer_cur_size = 0;
+    session->parser.buffer_head = 0;
+}
+
+blemb_bool_t blemb_protod_handle(blemb_protod_context_t * context, blemb_uint32_t connection_id, blemb_buffer_t data) {
+    if (context == NULL) return BLEMB_FALSE;
+    if (context->sessions == NULL || context->session_max_count == 0) return BLEMB_FALSE;
+    
+    blemb_protod_session_t * session = _blemb_protod_find_session(context, connection_id, BLEMB_TRUE);
+    if (session == NULL) return BLEMB_FALSE;
+    
+    blemb_protoh_context_t * parser = &session->parser;
+    
+    // Settings shared by all sessions are refreshed on every call, so they can be changed at any time.
+    parser->magic = context->magic;
+    parser->format = context->format;
+    parser->validator = context->validator;
+    parser->decompress_data = context->decompress_data;
+    parser->decompress_max_size = context->decompress_max_size;
+    parser->compression_dictionary = context->compression_dictionary;
+    parser->span_handler = _blemb_protod_deliver;
+    parser->user_data = context;
+    parser->stats = context->stats;
+    
+    if (parser->buffer_data == NULL) {
+        // An idle session only needs a buffer once a message may start.
+        if (blemb_scan_find_byte(data, 0, context->magic) >= data.size) {
+            BLEMB_STATS_ADD(context->stats, bytes_ingested, data.size);
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, data.size);
+            return BLEMB_TRUE;
+        }
+        
+        blemb_byte_t * block = blemb_pool_alloc(&context->pool);
+        if (block == NULL) return BLEMB_FALSE;
+        
+        parser->buffer_data = block;
+        parser->buffer_max_size = context->pool.block_size;
+        parser->buffer_cur_size = 0;
+        parser->buffer_head = 0;
+    }
+    
+    blemb_bool_t result = blemb_protoh_handle(parser, data);
+    
+    // Return the buffer to the pool as soon as no message is partially received.
+    if (parser->buffer_cur_size == 0) {
+        _blemb_protod_release_buffer(context, session);
+    }
+    
+    return result;
+}
+
+blemb_bool_t blemb_protod_handle_multiplexed(blemb_protod_context_t * context, blemb_buffer_t packet) {
+    if (context == NULL) return BLEMB_FALSE;
+    if (packet.data == NULL || packet.size < 1) return BLEMB_FALSE;
+    
+    return blemb_protod_handle(context, packet.data[0], blemb_buffer_init(packet.data + 1, packet.size - 1));
+}
+
+void blemb_protod_close(blemb_protod_context_t * context, blemb_uint32_t connection_id) {
+    if (context == NULL) return;
+    if (context->sessions == NULL || context->session_max_count == 0) return;
+    
+    blemb_protod_session_t * session = _blemb_protod_find_session(context, connection_id, BLEMB_FALSE);
+    if (session == NULL) return;
+    
+    _blemb_protod_release_buffer(context, session);
+    session->used = BLEMB_FALSE;
+    
+    // Backward shift: move later entries of the same probe chain into the hole,
+    // so lookups never stop early at an empty slot.
+    blemb_uint32_t hole = (blemb_uint32_t)(session - context->sessions);
+    blemb_uint32_t slot = hole;
+    for (blemb_uint32_t probe = 1; probe < context->session_max_count; probe++) {
+        slot = slot + 1 < context->session_max_count ? slot + 1 : 0;
+        
+        blemb_protod_session_t * candidate = &context->sessions[slot];
+        if (candidate->used == BLEMB_FALSE) break;
+        
+        // The entry can stay if its home slot lies cyclically in (hole, slot].
+        blemb_uint32_t home = _blemb_protod_home_slot(context, candidate->connection_id);
+        blemb_bool_t stays = hole <= slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (stays == BLEMB_TRUE) continue;
+        
+        context->sessions[hole] = *candidate;
+        candidate->used = BLEMB_FALSE;
+        hole = slot;
+    }
+}
@@ -7,197 +7,1656 @@
 
 // STDLIB
 #include <stddef.h>
+#include <string.h>
 
 // PUBLIC
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/crc8.h>
+#include <blemb/frame.h>
+#include <blemb/lz.h>
 #include <blemb/protoh.h>
 
 // PRIVATE
-#include <blemb_binary.h>
 #include <blemb_buffer.h>
 #include <blemb_crc8.h>
+#include <blemb_frame.h>
+#include <blemb_gf256.h>
+#include <blemb_lz.h>
+#include <blemb_scan.h>
+#include <blemb_stats.h>
 
-blemb_size_t _blemb_protoh_validate_message(blemb_buffer_t buffer, blemb_byte_t expected_magic, blemb_protoh_message_validator_f message_validator, blemb_buffer_t * result) {
-    // Check if magic is detected!
-    blemb_byte_t message_magic = 0;
-    if (blemb_binary_read_byte(buffer, 0, &message_magic) != BLEMB_BINARY_RESULT_SUCCESS) {
-        *result = blemb_buffer_empty();
-        return 0;
+// Message layout: magic (1) + payload size (2 in V1, 1-4 in V2) + payload + checksum (1).
+// See `blemb/frame.h`.
+
+// Parser states.
+#define _BLEMB_PROTOH_STATE_SEEK 0      // No candidate, looking for a magic byte.
+#define _BLEMB_PROTOH_STATE_HEADER 1    // Magic byte found, waiting for the payload size.
+#define _BLEMB_PROTOH_STATE_BODY 2      // Payload size known, checksumming payload bytes as they arrive.
+#define _BLEMB_PROTOH_STATE_SKIP 3      // Refused by `header_validator`, `parser_length` bytes left to drop.
+
+// Number of resynchronization candidates collected per scan.
+#define _BLEMB_PROTOH_SCAN_BATCH 16
+
+// Reliable reassembly states.
+#define _BLEMB_PROTOH_RELIABLE_IDLE 0           // No fragment received yet.
+#define _BLEMB_PROTOH_RELIABLE_RECEIVING 1      // Fragments of `fragment_sequence` arriving.
+#define _BLEMB_PROTOH_RELIABLE_DONE 2           // `fragment_sequence` delivered, its fragments are ignored.
+
+// Encoding of the message being streamed, besides `BLEMB_FRAME_ENCODING_RAW` and `_LZ`.
+#define _BLEMB_PROTOH_ENCODING_PENDING 0xFE     // Encoding byte not in yet.
+#define _BLEMB_PROTOH_ENCODING_INVALID 0xFF     // Unknown, or compressed without a window: dropped at the end.
+
+// Tracked candidate states (bounded mode).
+#define _BLEMB_PROTOH_CANDIDATE_HEADER 0    // Waiting for the payload size.
+#define _BLEMB_PROTOH_CANDIDATE_BODY 1      // Payload size known, checksumming payload bytes as they arrive.
+#define _BLEMB_PROTOH_CANDIDATE_REFUSED 2   // Refused by `header_validator`, dropped whole once it is the first.
+
+// -------
+// STORAGE
+// -------
+// Buffered bytes start at `buffer_head`. All offsets used by the parser are relative
+// to it. In ring mode they may wrap around the end of `buffer_data`; otherwise
+// `buffer_head + buffer_cur_size` never exceeds `buffer_max_size`.
+blemb_offset_t _blemb_protoh_storage_index(blemb_protoh_context_t * context, blemb_offset_t offset) {
+    // `buffer_head + offset` will not overflow, both are lower than `buffer_max_size`.
+    blemb_offset_t index = context->buffer_head + offset;
+    if (context->buffer_ring == BLEMB_TRUE && index >= context->buffer_max_size) {
+        index -= context->buffer_max_size;
     }
-    if (message_magic != expected_magic) {
-        *result = blemb_buffer_empty();
-        return 0;
+    
+    return index;
+}
+
+void _blemb_protoh_storage_spans(blemb_protoh_context_t * context, blemb_offset_t offset, blemb_size_t size, blemb_buffer_t * first, blemb_buffer_t * second) {
+    blemb_offset_t index = _blemb_protoh_storage_index(context, offset);
+    blemb_size_t contiguous_size = context->buffer_max_size - index;
+    
+    if (size <= contiguous_size) {
+        *first = blemb_buffer_init(context->buffer_data + index, size);
+        *second = blemb_buffer_init(context->buffer_data, 0);
+    } else {
+        *first = blemb_buffer_init(context->buffer_data + index, contiguous_size);
+        *second = blemb_buffer_init(context->buffer_data, size - contiguous_size);
     }
+}
+
+blemb_byte_t _blemb_protoh_storage_byte(blemb_protoh_context_t * context, blemb_offset_t offset) {
+    return context->buffer_data[_blemb_protoh_storage_index(context, offset)];
+}
+
+void _blemb_protoh_storage_copy(blemb_protoh_context_t * context, blemb_offset_t offset, blemb_byte_t * data, blemb_size_t size) {
+    blemb_buffer_t first, second;
+    _blemb_protoh_storage_spans(context, offset, size, &first, &second);
     
-    // Get message size!
-    blemb_uint16_t message_size = 0;
-    if (blemb_binary_read_uint16(buffer, 1, BLEMB_BINARY_ENDIANNESS_BIG, &message_size) != BLEMB_BINARY_RESULT_SUCCESS) {
-        *result = blemb_buffer_empty();
-        return 0;
+    memcpy(data, first.data, first.size);
+    memcpy(data + first.size, second.data, second.size);
+}
+
+void _blemb_protoh_storage_append(blemb_protoh_context_t * context, const blemb_byte_t * data, blemb_size_t size) {
+    // The caller makes sure `size` fits in the free space.
+    if (context->buffer_ring == BLEMB_FALSE && context->buffer_head + context->buffer_cur_size + size > context->buffer_max_size) {
+        // Linear mode: make room at the end by moving the buffered bytes to the start.
+        memmove(context->buffer_data, context->buffer_data + context->buffer_head, context->buffer_cur_size);
+        context->buffer_head = 0;
     }
     
-    // Get message data!
-    blemb_buffer_t message = blemb_buffer_slice(buffer, 3, message_size);
-    if (blemb_buffer_is_empty(message) == BLEMB_TRUE && message_size > 0) {
-        *result = blemb_buffer_empty();
-        return 0;
+    blemb_buffer_t first, second;
+    _blemb_protoh_storage_spans(context, context->buffer_cur_size, size, &first, &second);
+    
+    memcpy(first.data, data, first.size);
+    memcpy(second.data, data + first.size, second.size);
+    context->buffer_cur_size += size;
+}
+
+void _blemb_protoh_storage_free_span(blemb_protoh_context_t * context, blemb_buffer_t * span) {
+    // Contiguous free space right after the buffered bytes. In ring mode it ends at the
+    // end of `buffer_data` or at `buffer_head`, whichever comes first.
+    blemb_offset_t index = _blemb_protoh_storage_index(context, context->buffer_cur_size);
+    blemb_size_t size = context->buffer_max_size - index;
+    if (context->buffer_ring == BLEMB_TRUE) {
+        if (context->buffer_cur_size == context->buffer_max_size) {
+            size = 0;
+        } else if (index < context->buffer_head) {
+            size = context->buffer_head - index;
+        }
     }
     
-    // Compute CRC8
-    blemb_byte_t calculated_checksum = blemb_crc8_compute(message);
+    *span = blemb_buffer_init(context->buffer_data + index, size);
+}
+
+void _blemb_protoh_storage_reverse(blemb_byte_t * data, blemb_size_t size) {
+    for (blemb_offset_t i = 0; i < size / 2; i++) {
+        blemb_byte_t byte = data[i];
+        data[i] = data[size - 1 - i];
+        data[size - 1 - i] = byte;
+    }
+}
+
+void _blemb_protoh_storage_linearize(blemb_protoh_context_t * context) {
+    // Rotate the ring in place so the buffered bytes start at index 0 and no longer
+    // wrap. Only needed when a message that wraps must be handed over in one piece,
+    // which happens at most once per lap around the ring.
+    _blemb_protoh_storage_reverse(context->buffer_data, context->buffer_head);
+    _blemb_protoh_storage_reverse(context->buffer_data + context->buffer_head, context->buffer_max_size - context->buffer_head);
+    _blemb_protoh_storage_reverse(context->buffer_data, context->buffer_max_size);
     
-    blemb_byte_t checksum = 0;
-    if (blemb_binary_read_byte(buffer, 3 + message_size, &checksum) != BLEMB_BINARY_RESULT_SUCCESS) {
-        *result = blemb_buffer_empty();
-        return 0;
+    context->buffer_head = 0;
+}
+
+// ------
+// PARSER
+// ------
+void _blemb_protoh_reset_parser(blemb_protoh_context_t * context) {
+    context->parser_state = _BLEMB_PROTOH_STATE_SEEK;
+    context->parser_offset = 0;
+    context->parser_length = 0;
+    context->parser_crc = blemb_crc8_init();
+}
+
+void _blemb_protoh_discard(blemb_protoh_context_t * context, blemb_size_t size) {
+    // Remove processed bytes to free up buffer space. Only the head index moves,
+    // buffered bytes stay where they are.
+    if (size >= context->buffer_cur_size) {
+        context->buffer_cur_size = 0;
+        context->buffer_head = 0;
+    } else {
+        context->buffer_head = _blemb_protoh_storage_index(context, size);
+        context->buffer_cur_size = context->buffer_cur_size - size;
     }
-    if (checksum != calculated_checksum) {
-        *result = blemb_buffer_empty();
-        return 0;
+    
+    _blemb_protoh_reset_parser(context);
+}
+
+void _blemb_protoh_skip_current_candidate(blemb_protoh_context_t * context) {
+    // The current candidate always starts at offset 0. Dropping its magic byte
+    // makes the parser look for the next candidate within the buffered bytes.
+    BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+    _blemb_protoh_discard(context, 1);
+}
+
+blemb_frame_result_t _blemb_protoh_read_header(blemb_protoh_context_t * context, blemb_offset_t offset, blemb_size_t * message_size, blemb_size_t * header_size) {
+    // `buffer_cur_size - offset` will not underflow, `offset` is always a buffered byte.
+    blemb_size_t available = context->buffer_cur_size - offset;
+    if (available > BLEMB_FRAME_HEADER_MAX_SIZE) {
+        available = BLEMB_FRAME_HEADER_MAX_SIZE;
     }
     
-    if (message_validator != NULL && message_validator(message) == BLEMB_FALSE) {
-        *result = blemb_buffer_empty();
-        return 0;
+    blemb_byte_t header_data[BLEMB_FRAME_HEADER_MAX_SIZE];
+    _blemb_protoh_storage_copy(context, offset, header_data, available);
+    
+    return blemb_frame_read_header(context->format, header_data, available, message_size, header_size);
+}
+
+blemb_size_t _blemb_protoh_header_bytes_needed(blemb_protoh_context_t * context, blemb_offset_t offset) {
+    // Bytes missing to complete the header of the candidate at `offset`. V2 sizes are
+    // only known byte by byte, so one at a time is requested past the shortest header.
+    blemb_size_t available = context->buffer_cur_size - offset;
+    blemb_size_t minimum = blemb_frame_header_min_size(context->format);
+    
+    return available < minimum ? minimum - available : 1;
+}
+
+blemb_bool_t _blemb_protoh_header_fits(blemb_protoh_context_t * context, blemb_size_t header_size, blemb_size_t message_size) {
+    // A message that does not fit in the buffer can never be delivered.
+    // This will never overflow, `message_size` has a maximum value of 2^28 - 1.
+    return header_size + message_size + BLEMB_FRAME_TRAILER_SIZE <= context->buffer_max_size ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_bool_t _blemb_protoh_candidate_fits(blemb_protoh_context_t * context, blemb_offset_t offset) {
+    // Without a complete header the candidate can not be ruled out yet.
+    blemb_size_t message_size = 0;
+    blemb_size_t header_size = 0;
+    blemb_frame_result_t result = _blemb_protoh_read_header(context, offset, &message_size, &header_size);
+    if (result == BLEMB_FRAME_RESULT_INCOMPLETE) return BLEMB_TRUE;
+    if (result == BLEMB_FRAME_RESULT_INVALID) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+        return BLEMB_FALSE;
+    }
+    
+    // A `header_validator` gets to refuse it first, which drops the whole message (see
+    // `_blemb_protoh_process`).
+    if (_blemb_protoh_header_fits(context, header_size, message_size) == BLEMB_FALSE && context->header_validator == NULL) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+        return BLEMB_FALSE;
+    }
+    return BLEMB_TRUE;
+}
+
+blemb_offset_t _blemb_protoh_find_next_candidate(blemb_protoh_context_t * context) {
+    // Collect the magic byte positions in one vectorized pass and walk them in order,
+    // so resynchronization never restarts the scan from the beginning of the buffer.
+    // Candidates ruled out by their header alone are skipped without moving any data.
+    blemb_offset_t candidates[_BLEMB_PROTOH_SCAN_BATCH];
+    
+    blemb_buffer_t spans[2];
+    _blemb_protoh_storage_spans(context, 0, context->buffer_cur_size, &spans[0], &spans[1]);
+    
+    blemb_offset_t span_offset = 0;
+    for (blemb_uint32_t i = 0; i < 2; i++) {
+        blemb_offset_t offset = 0;
+        while (offset < spans[i].size) {
+            blemb_size_t count = blemb_scan_find_all(spans[i], offset, context->magic, candidates, _BLEMB_PROTOH_SCAN_BATCH, &offset);
+            
+            for (blemb_size_t j = 0; j < count; j++) {
+                if (_blemb_protoh_candidate_fits(context, span_offset + candidates[j]) == BLEMB_TRUE) {
+                    return span_offset + candidates[j];
+                }
+            }
+        }
+        span_offset += spans[i].size;
     }
     
-    *result = message;
-    return 1 + 2 + message_size + 1;
+    return context->buffer_cur_size;
 }
 
-blemb_size_t _blemb_protoh_try_to_find_next_message(blemb_buffer_t buffer, blemb_byte_t expected_magic, blemb_protoh_message_validator_f message_validator, blemb_buffer_t * result) {
-    for (blemb_offset_t offset = 0; offset < buffer.size; offset++) {
-        // No need to check for overflows: the for loop ensures `offset` is never greater
-        // than the buffer size. Even if it were, `slice` would return an empty buffer.
-        // Similarly, `buffer.size - offset` won’t underflow, since `offset` is always lower
-        // than buffer size.
-        blemb_buffer_t buf = blemb_buffer_slice(buffer, offset, buffer.size - offset);
+blemb_size_t _blemb_protoh_message_size(blemb_protoh_context_t * context, blemb_size_t payload_size) {
+    // Whole message, framing included. Sizes are always encoded with the fewest bytes,
+    // so the header size follows from the payload size.
+    return blemb_frame_header_size(context->format, payload_size) + payload_size + BLEMB_FRAME_TRAILER_SIZE;
+}
+
+blemb_bool_t _blemb_protoh_is_bounded(blemb_protoh_context_t * context) {
+    return context->candidates != NULL && context->candidate_max_count > 0 ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_size_t _blemb_protoh_bytes_needed(blemb_protoh_context_t * context) {
+    // Number of bytes that must be buffered before the parser can make progress.
+    // It never exceeds the free buffer space: candidates that would not fit in the
+    // buffer are rejected as soon as their payload size is known.
+    if (_blemb_protoh_is_bounded(context) == BLEMB_TRUE) {
+        // Nothing is delivered before the first candidate is resolved, so only
+        // its bytes are buffered. The others are followed within them.
+        if (context->candidate_count == 0) return 1;
         
-        // Using the new buffer, attempt to parse a valid message.
-        blemb_buffer_t message = blemb_buffer_empty();
-        blemb_size_t bytes_to_be_processed = _blemb_protoh_validate_message(buf, expected_magic, message_validator, &message);
+        blemb_protoh_candidate_t * first = &context->candidates[0];
+        if (first->state == _BLEMB_PROTOH_CANDIDATE_HEADER) {
+            return _blemb_protoh_header_bytes_needed(context, 0);
+        }
         
-        // If the system is ready to process bytes, a valid message has been detected.
-        // Stop searching for a message and return the number of bytes the caller should skip to process it.
-        if (bytes_to_be_processed > 0) {
-            // No need to check for overflows: `offset + bytes_to_be_processed` won’t overflow,
-            // because `bytes_to_be_processed` is always less than the remaining buffer size,
-            // in that case, `buffer.size - offset`.
-            *result = message;
-            return offset + bytes_to_be_processed;
+        return _blemb_protoh_message_size(context, first->length) - context->buffer_cur_size;
+    }
+    
+    switch (context->parser_state) {
+        case _BLEMB_PROTOH_STATE_HEADER:
+            return _blemb_protoh_header_bytes_needed(context, 0);
+        case _BLEMB_PROTOH_STATE_BODY:
+            return _blemb_protoh_message_size(context, context->parser_length) - context->buffer_cur_size;
+        default:
+            return 1;
+    }
+}
+
+blemb_bool_t _blemb_protoh_header_accepted(blemb_protoh_context_t * context, blemb_size_t message_size) {
+    if (context->header_validator == NULL || context->header_validator(context, message_size) == BLEMB_TRUE) {
+        return BLEMB_TRUE;
+    }
+    
+    BLEMB_STATS_ADD(context->stats, validator_rejects, 1);
+    return BLEMB_FALSE;
+}
+
+void _blemb_protoh_skip_message(blemb_protoh_context_t * context, blemb_size_t message_size) {
+    // Drop the buffered bytes of a refused message, then the rest of it as it arrives.
+    blemb_size_t total_size = _blemb_protoh_message_size(context, message_size);
+    if (context->buffer_cur_size >= total_size) {
+        _blemb_protoh_discard(context, total_size);
+        return;
+    }
+    
+    total_size -= context->buffer_cur_size;
+    _blemb_protoh_discard(context, context->buffer_cur_size);
+    context->parser_state = _BLEMB_PROTOH_STATE_SKIP;
+    context->parser_length = total_size;
+}
+
+blemb_size_t _blemb_protoh_skip_input(blemb_protoh_context_t * context, blemb_buffer_t data, blemb_offset_t offset) {
+    // Returns the number of bytes of `data`, from `offset`, that belong to the refused message.
+    blemb_size_t size = data.size - offset;
+    if (size > context->parser_length) {
+        size = context->parser_length;
+    }
+    
+    context->parser_length -= size;
+    if (context->parser_length == 0) {
+        _blemb_protoh_reset_parser(context);
+    }
+    return size;
+}
+
+blemb_bool_t _blemb_protoh_decode(blemb_protoh_context_t * context, blemb_buffer_t * message, blemb_buffer_t * message_tail) {
+    // In a compressed format, drops the encoding byte and, when the message is compressed,
+    // decodes it into `decompress_data`. Returns `BLEMB_FALSE` when it can not be decoded.
+    if (blemb_frame_encoding_size(context->format) == 0) return BLEMB_TRUE;
+    
+    if (message->size == 0) {
+        *message = *message_tail;
+        *message_tail = blemb_buffer_init(message_tail->data, 0);
+    }
+    if (message->size == 0) return BLEMB_FALSE;
+    
+    blemb_byte_t encoding = message->data[0];
+    *message = blemb_buffer_init(message->data + 1, message->size - 1);
+    if (encoding == BLEMB_FRAME_ENCODING_RAW) return BLEMB_TRUE;
+    if (encoding != BLEMB_FRAME_ENCODING_LZ || context->decompress_data == NULL) return BLEMB_FALSE;
+    
+    // Nothing is taken from the decoder, so `decompress_data` ends up holding the whole message.
+    blemb_lz_decoder_t decoder;
+    blemb_lz_decoder_init(&decoder, context->compression_dictionary, context->decompress_data, context->decompress_max_size);
+    if (blemb_lz_decode(&decoder, *message) < message->size) return BLEMB_FALSE;
+    if (blemb_lz_decode(&decoder, *message_tail) < message_tail->size) return BLEMB_FALSE;
+    if (blemb_lz_decoder_is_complete(&decoder) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    *message = blemb_buffer_init(context->decompress_data, decoder.produced);
+    *message_tail = blemb_buffer_init(context->decompress_data, 0);
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t _blemb_protoh_deliver_spans(blemb_protoh_context_t * context, blemb_buffer_t message, blemb_buffer_t message_tail) {
+    if (_blemb_protoh_decode(context, &message, &message_tail) == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, decompress_failures, 1);
+        return BLEMB_FALSE;
+    }
+    
+    if (context->validator != NULL && context->validator(message) == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, validator_rejects, 1);
+        return BLEMB_FALSE;
+    }
+    
+    // Notify the user.
+    BLEMB_STATS_ADD(context->stats, messages_delivered, 1);
+    if (context->span_handler != NULL) {
+        context->span_handler(context, message, message_tail);
+    } else if (context->handler != NULL) {
+        context->handler(message);
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t _blemb_protoh_deliver(blemb_protoh_context_t * context) {
+    blemb_size_t header_size = blemb_frame_header_size(context->format, context->parser_length);
+    
+    blemb_buffer_t message, message_tail;
+    _blemb_protoh_storage_spans(context, header_size, context->parser_length, &message, &message_tail);
+    
+    // A message that wraps around the end of the ring is only handed over in
+    // two pieces to a span handler. Everything else needs it contiguous.
+    if (message_tail.size > 0 && (context->validator != NULL || context->span_handler == NULL)) {
+        _blemb_protoh_storage_linearize(context);
+        _blemb_protoh_storage_spans(context, header_size, context->parser_length, &message, &message_tail);
+    }
+    
+    return _blemb_protoh_deliver_spans(context, message, message_tail);
+}
+
+blemb_size_t _blemb_protoh_direct(blemb_protoh_context_t * context, blemb_buffer_t data, blemb_offset_t offset, blemb_size_t work_left, blemb_size_t * work) {
+    // Fast path for an empty context: a message that is whole in the input, from the magic
+    // byte at `offset`, is checked and handed over as a slice of `data`, without being
+    // buffered. Outcomes match the buffered path. Returns the number of bytes taken:
+    // zero when the message must be buffered, one when its magic byte was a false match.
+    blemb_size_t message_size = 0;
+    blemb_size_t header_size = 0;
+    blemb_frame_result_t result = blemb_frame_read_header(context->format, data.data + offset, data.size - offset, &message_size, &header_size);
+    if (result == BLEMB_FRAME_RESULT_INCOMPLETE) return 0;
+    
+    if (result == BLEMB_FRAME_RESULT_INVALID) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+        BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+        return 1;
+    }
+    
+    // `data.size - offset` will not underflow, `offset` is always an input byte.
+    blemb_size_t total_size = header_size + message_size + BLEMB_FRAME_TRAILER_SIZE;
+    if (total_size > data.size - offset || message_size > work_left) return 0;
+    
+    if (_blemb_protoh_header_accepted(context, message_size) == BLEMB_FALSE) return total_size;
+    
+    if (_blemb_protoh_header_fits(context, header_size, message_size) == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+        BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+        return 1;
+    }
+    
+    blemb_buffer_t message = blemb_buffer_init(data.data + offset + header_size, message_size);
+    *work += message_size;
+    if (data.data[offset + header_size + message_size] != blemb_crc8_compute(message)) {
+        BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+        BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+        return 1;
+    }
+    
+    if (_blemb_protoh_deliver_spans(context, message, blemb_buffer_init(data.data, 0)) == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+        return 1;
+    }
+    
+    return total_size;
+}
+
+blemb_size_t _blemb_protoh_process(blemb_protoh_context_t * context) {
+    // Returns the number of byte steps (scans and checksum updates) done.
+    blemb_size_t work = 0;
+    
+    while (context->buffer_cur_size > 0) {
+        if (context->parser_state == _BLEMB_PROTOH_STATE_SEEK) {
+            // Only reached after a candidate has been skipped, or after bytes were written
+            // straight into the buffer: look for the next magic byte within them.
+            blemb_offset_t candidate_offset = _blemb_protoh_find_next_candidate(context);
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, candidate_offset);
+            work += candidate_offset;
+            _blemb_protoh_discard(context, candidate_offset);
+            
+            if (context->buffer_cur_size > 0) {
+                context->parser_state = _BLEMB_PROTOH_STATE_HEADER;
+            }
+            continue;
+        }
+        
+        if (context->parser_state == _BLEMB_PROTOH_STATE_HEADER) {
+            // Get message size!
+            blemb_size_t message_size = 0;
+            blemb_size_t header_size = 0;
+            blemb_frame_result_t result = _blemb_protoh_read_header(context, 0, &message_size, &header_size);
+            if (result == BLEMB_FRAME_RESULT_INCOMPLETE) {
+                return work;
+            }
+            
+            if (result == BLEMB_FRAME_RESULT_INVALID) {
+                BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+                _blemb_protoh_skip_current_candidate(context);
+                continue;
+            }
+            
+            // Asked before the size check, so a message too large for the buffer is dropped
+            // whole too instead of being searched for magic bytes.
+            if (_blemb_protoh_header_accepted(context, message_size) == BLEMB_FALSE) {
+                // Bytes past the message, if any, may hold the next candidate. Otherwise
+                // the rest of it is dropped from the input (see `_blemb_protoh_handle`).
+                _blemb_protoh_skip_message(context, message_size);
+                if (context->parser_state == _BLEMB_PROTOH_STATE_SKIP) return work;
+                continue;
+            }
+            
+            if (_blemb_protoh_header_fits(context, header_size, message_size) == BLEMB_FALSE) {
+                BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+                _blemb_protoh_skip_current_candidate(context);
+                continue;
+            }
+            
+            context->parser_state = _BLEMB_PROTOH_STATE_BODY;
+            context->parser_offset = header_size;
+            context->parser_length = message_size;
+            context->parser_crc = blemb_crc8_init();
+            continue;
+        }
+        
+        // Checksum the payload bytes received since the last call, so every byte
+        // goes through the CRC exactly once.
+        blemb_size_t payload_end = blemb_frame_header_size(context->format, context->parser_length) + context->parser_length;
+        blemb_size_t available_end = context->buffer_cur_size < payload_end ? context->buffer_cur_size : payload_end;
+        if (available_end > context->parser_offset) {
+            blemb_buffer_t first, second;
+            _blemb_protoh_storage_spans(context, context->parser_offset, available_end - context->parser_offset, &first, &second);
+            
+            context->parser_crc = blemb_crc8_update(context->parser_crc, first);
+            context->parser_crc = blemb_crc8_update(context->parser_crc, second);
+            work += available_end - context->parser_offset;
+            context->parser_offset = available_end;
         }
+        
+        // Wait for the rest of the message.
+        if (context->buffer_cur_size <= payload_end) {
+            return work;
+        }
+        
+        blemb_byte_t checksum = _blemb_protoh_storage_byte(context, payload_end);
+        if (checksum != blemb_crc8_final(context->parser_crc)) {
+            BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+            _blemb_protoh_skip_current_candidate(context);
+            continue;
+        }
+        
+        if (_blemb_protoh_deliver(context) == BLEMB_FALSE) {
+            _blemb_protoh_skip_current_candidate(context);
+            continue;
+        }
+        
+        _blemb_protoh_discard(context, payload_end + 1);
     }
     
-    *result = blemb_buffer_empty();
-    return 0;
+    // Nothing buffered, so there is no candidate either.
+    _blemb_protoh_reset_parser(context);
+    return work;
 }
 
-blemb_bool_t _blemb_protoh_process_next_message(blemb_protoh_context_t * context) {
-    if (context == NULL) return BLEMB_FALSE;
+// ------------
+// BOUNDED MODE
+// ------------
+// Every magic byte is registered once, when it is buffered, and each tracked
+// candidate checksums its own payload bytes once, as they arrive. Candidates are
+// kept in buffer order and the first one always starts at offset 0: it is the
+// only one that can be delivered, the others are resolved after it.
+// `parser_offset` holds the number of buffered bytes already scanned.
+void _blemb_protoh_bounded_discard(blemb_protoh_context_t * context, blemb_size_t size) {
+    // Remove processed bytes together with every candidate starting within them.
+    if (size >= context->buffer_cur_size) {
+        context->buffer_cur_size = 0;
+        context->buffer_head = 0;
+    } else {
+        context->buffer_head = _blemb_protoh_storage_index(context, size);
+        context->buffer_cur_size = context->buffer_cur_size - size;
+    }
     
-    // Create a temporary buffer from the current `protoh` context state.
-    blemb_buffer_t buffer = blemb_buffer_init(context->buffer_data, context->buffer_cur_size);
+    blemb_uint32_t kept_count = 0;
+    for (blemb_uint32_t i = 0; i < context->candidate_count; i++) {
+        if (context->candidates[i].offset < size) continue;
+        
+        context->candidates[kept_count] = context->candidates[i];
+        context->candidates[kept_count].offset -= size;
+        kept_count++;
+    }
+    context->candidate_count = kept_count;
     
-    // Using the current `protoh` context state, attempt to parse a valid message.
-    blemb_buffer_t message = blemb_buffer_empty();
-    blemb_size_t bytes_to_be_processed = _blemb_protoh_try_to_find_next_message(buffer, context->magic, context->validator, &message);
+    context->parser_offset = context->parser_offset > size ? context->parser_offset - size : 0;
+}
+
+void _blemb_protoh_bounded_reject_first(blemb_protoh_context_t * context) {
+    // Drop the first candidate and the bytes up to the next one. Magic bytes in
+    // between were either tracked or ignored for good, so they are not looked at again.
+    blemb_offset_t next_offset = context->candidate_count > 1 ? context->candidates[1].offset : context->buffer_cur_size;
+    BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, next_offset);
+    _blemb_protoh_bounded_discard(context, next_offset);
+}
+
+blemb_size_t _blemb_protoh_bounded_register(blemb_protoh_context_t * context) {
+    // Register the magic bytes among the bytes buffered since the last call.
+    blemb_size_t new_size = context->buffer_cur_size - context->parser_offset;
+    if (new_size == 0) return 0;
+    
+    blemb_offset_t positions[_BLEMB_PROTOH_SCAN_BATCH];
+    
+    blemb_buffer_t spans[2];
+    _blemb_protoh_storage_spans(context, context->parser_offset, new_size, &spans[0], &spans[1]);
+    
+    blemb_offset_t span_offset = context->parser_offset;
+    for (blemb_uint32_t i = 0; i < 2; i++) {
+        blemb_offset_t offset = 0;
+        while (offset < spans[i].size) {
+            blemb_size_t count = blemb_scan_find_all(spans[i], offset, context->magic, positions, _BLEMB_PROTOH_SCAN_BATCH, &offset);
+            
+            for (blemb_size_t j = 0; j < count; j++) {
+                if (context->candidate_count == context->candidate_max_count) {
+                    BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+                    continue;
+                }
+                
+                blemb_protoh_candidate_t * candidate = &context->candidates[context->candidate_count++];
+                candidate->offset = span_offset + positions[j];
+                candidate->checked = 0;
+                candidate->length = 0;
+                candidate->state = _BLEMB_PROTOH_CANDIDATE_HEADER;
+                candidate->crc = blemb_crc8_init();
+            }
+        }
+        span_offset += spans[i].size;
+    }
     
-    // If the system is ready to process bytes, a valid message has been detected.
-    // Notify the caller of the new message, process it, and discard the corresponding
-    // bytes from the `protoh` context.
-    if (bytes_to_be_processed) {
-        // Notify the user.
-        if (context->handler != NULL) {
-            context->handler(message);
+    context->parser_offset = context->buffer_cur_size;
+    return new_size;
+}
+
+blemb_size_t _blemb_protoh_bounded_advance(blemb_protoh_context_t * context) {
+    // Move every candidate over the bytes it has not checksummed yet.
+    blemb_size_t work = 0;
+    
+    blemb_uint32_t i = 0;
+    while (i < context->candidate_count) {
+        blemb_protoh_candidate_t * candidate = &context->candidates[i];
+        if (candidate->state == _BLEMB_PROTOH_CANDIDATE_REFUSED) {
+            i++;
+            continue;
         }
         
-        // Move unprocessed data before discarding bytes to free up space.
-        for (blemb_offset_t offset = bytes_to_be_processed; offset < context->buffer_cur_size; offset++) {
-            context->buffer_data[offset - bytes_to_be_processed] = context->buffer_data[offset];
+        if (candidate->state == _BLEMB_PROTOH_CANDIDATE_HEADER) {
+            blemb_size_t message_size = 0;
+            blemb_size_t header_size = 0;
+            blemb_frame_result_t result = _blemb_protoh_read_header(context, candidate->offset, &message_size, &header_size);
+            if (result == BLEMB_FRAME_RESULT_INCOMPLETE) {
+                i++;
+                continue;
+            }
+            
+            if (result != BLEMB_FRAME_RESULT_INVALID && _blemb_protoh_header_accepted(context, message_size) == BLEMB_FALSE) {
+                // Kept, without checksumming anything, until the candidates before it are
+                // resolved: it is only a message to drop if none of them is delivered.
+                candidate->state = _BLEMB_PROTOH_CANDIDATE_REFUSED;
+                candidate->length = message_size;
+                i++;
+                continue;
+            }
+            
+            blemb_bool_t rejected = BLEMB_TRUE;
+            if (result == BLEMB_FRAME_RESULT_INVALID) {
+                BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+            } else if (_blemb_protoh_header_fits(context, header_size, message_size) == BLEMB_FALSE) {
+                BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+            } else {
+                rejected = BLEMB_FALSE;
+            }
+            
+            if (rejected == BLEMB_TRUE) {
+                // The first candidate can only be dropped with the bytes that precede the next one.
+                if (i == 0) {
+                    _blemb_protoh_bounded_reject_first(context);
+                } else {
+                    memmove(candidate, candidate + 1, (context->candidate_count - i - 1) * sizeof(*candidate));
+                    context->candidate_count--;
+                }
+                continue;
+            }
+            
+            candidate->state = _BLEMB_PROTOH_CANDIDATE_BODY;
+            candidate->length = message_size;
         }
-        // Remove processed bytes to free up buffer space.
-        context->buffer_cur_size = context->buffer_cur_size - bytes_to_be_processed;
         
-        return BLEMB_TRUE;
+        // `candidate->offset` is a buffered byte, so none of these overflow.
+        blemb_size_t payload_start = candidate->offset + blemb_frame_header_size(context->format, candidate->length);
+        blemb_size_t payload_end = payload_start + candidate->length;
+        blemb_size_t available_end = context->buffer_cur_size < payload_end ? context->buffer_cur_size : payload_end;
+        blemb_size_t checked_end = payload_start + candidate->checked;
+        if (available_end > checked_end) {
+            blemb_buffer_t first, second;
+            _blemb_protoh_storage_spans(context, checked_end, available_end - checked_end, &first, &second);
+            
+            candidate->crc = blemb_crc8_update(candidate->crc, first);
+            candidate->crc = blemb_crc8_update(candidate->crc, second);
+            candidate->checked += available_end - checked_end;
+            work += available_end - checked_end;
+        }
+        
+        i++;
     }
     
-    return BLEMB_FALSE;
+    return work;
 }
 
-void _blemb_protoh_skip_current_candidate(blemb_protoh_context_t * context) {
-    if (context == NULL) return;
+blemb_size_t _blemb_protoh_bounded_process(blemb_protoh_context_t * context) {
+    // Returns the number of byte steps (scans and checksum updates) done.
+    blemb_size_t work = 0;
+    
+    while (context->buffer_cur_size > 0) {
+        work += _blemb_protoh_bounded_register(context);
+        
+        // Bytes before the first candidate are garbage. Only bytes written straight into
+        // the buffer (see `blemb_protoh_commit`) can leave some.
+        if (context->candidate_count > 0 && context->candidates[0].offset > 0) {
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, context->candidates[0].offset);
+            _blemb_protoh_bounded_discard(context, context->candidates[0].offset);
+        }
+        
+        work += _blemb_protoh_bounded_advance(context);
+        
+        if (context->candidate_count == 0) {
+            // Every buffered magic byte has been ruled out or ignored.
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, context->buffer_cur_size);
+            _blemb_protoh_bounded_discard(context, context->buffer_cur_size);
+            break;
+        }
+        
+        // A refused first candidate is a message to drop, with every candidate inside it.
+        // What is not buffered yet is dropped from the input (see `_blemb_protoh_handle`).
+        blemb_protoh_candidate_t * first = &context->candidates[0];
+        if (first->state == _BLEMB_PROTOH_CANDIDATE_REFUSED) {
+            blemb_size_t total_size = _blemb_protoh_message_size(context, first->length);
+            if (context->buffer_cur_size >= total_size) {
+                _blemb_protoh_bounded_discard(context, total_size);
+                continue;
+            }
+            
+            context->parser_state = _BLEMB_PROTOH_STATE_SKIP;
+            context->parser_length = total_size - context->buffer_cur_size;
+            _blemb_protoh_bounded_discard(context, context->buffer_cur_size);
+            break;
+        }
+        
+        // Wait for the rest of the first candidate.
+        blemb_size_t payload_end = blemb_frame_header_size(context->format, first->length) + first->length;
+        if (first->state == _BLEMB_PROTOH_CANDIDATE_HEADER || context->buffer_cur_size <= payload_end) {
+            break;
+        }
+        
+        blemb_byte_t checksum = _blemb_protoh_storage_byte(context, payload_end);
+        if (checksum != blemb_crc8_final(first->crc)) {
+            BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+            _blemb_protoh_bounded_reject_first(context);
+            continue;
+        }
+        
+        context->parser_length = first->length;
+        if (_blemb_protoh_deliver(context) == BLEMB_FALSE) {
+            _blemb_protoh_bounded_reject_first(context);
+            continue;
+        }
+        
+        // Candidates inside the message were payload bytes. The bytes between it and
+        // the next candidate, if any, are garbage.
+        _blemb_protoh_bounded_discard(context, payload_end + 1);
+        if (context->candidate_count > 0 && context->candidates[0].offset > 0) {
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, context->candidates[0].offset);
+            _blemb_protoh_bounded_discard(context, context->candidates[0].offset);
+        }
+    }
+    
+    return work;
+}
+
+// --------
+// RELIABLE
+// --------
+// Fragment `index` lands at `index * fragment_size` in the buffer, so fragments are placed
+// as they come, in any order, and each one is copied once. The fragment size is learnt from
+// the first parity fragment or data fragment that is not the last: until then only
+// fragment 0 can be placed. `buffer_cur_size` is the size of the whole message once known.
+void _blemb_protoh_reliable_start(blemb_protoh_context_t * context, blemb_uint8_t sequence) {
+    memset(context->fragment_map, 0, context->fragment_map_size);
+    
+    // Every parity slot starts empty (see `_blemb_protoh_reliable_slot`).
+    if (context->fec_buffer != NULL) {
+        memset(context->fec_buffer, 0xFF, context->fec_buffer_size);
+    }
+    
+    context->fragment_state = _BLEMB_PROTOH_RELIABLE_RECEIVING;
+    context->fragment_sequence = sequence;
+    context->fragment_size = 0;
+    context->fragment_count = 0;
+    context->fragment_received = 0;
+    context->fragment_end = 0;
+    context->fragment_parked = 0;
+    context->buffer_cur_size = 0;
+}
+
+blemb_bool_t _blemb_protoh_reliable_has(blemb_protoh_context_t * context, blemb_size_t index) {
+    return (context->fragment_map[index / 8] & (1 << (index % 8))) != 0 ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_size_t _blemb_protoh_reliable_length(blemb_protoh_context_t * context, blemb_size_t index) {
+    // All fragments are full but the last one, counted full until the message size is known.
+    if (index + 1 == context->fragment_count && context->buffer_cur_size > 0) {
+        return context->buffer_cur_size - index * context->fragment_size;
+    }
+    
+    return context->fragment_size;
+}
+
+void _blemb_protoh_reliable_unpark(blemb_protoh_context_t * context) {
+    // Moves a parked last fragment (see `_blemb_protoh_reliable_place`) to its place, now
+    // that `fragment_size` is known. One that does not fit the size is dropped.
+    blemb_size_t size = context->fragment_parked;
+    if (size == 0) return;
+    context->fragment_parked = 0;
+    
+    blemb_size_t index = context->fragment_count - 1;
+    if (size > context->fragment_size || index / 8 >= context->fragment_map_size) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+        return;
+    }
+    
+    blemb_offset_t offset = index * context->fragment_size;
+    if (offset + size > context->buffer_max_size) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+        return;
+    }
+    
+    // The two ranges may overlap.
+    memmove(context->buffer_data + offset, context->buffer_data + context->buffer_max_size - size, size);
+    context->fragment_map[index / 8] |= (blemb_byte_t)(1 << (index % 8));
+    context->fragment_received++;
+    context->buffer_cur_size = offset + size;
+}
+
+void _blemb_protoh_reliable_learn_size(blemb_protoh_context_t * context) {
+    // Works out the message size, and so the fragment count, from the header in fragment 0
+    // so the last fragment can be rebuilt from parity, or asked for, without being seen.
+    if (context->buffer_cur_size > 0 || context->fragment_size == 0) return;
+    
+    blemb_size_t available = 0;
+    for (blemb_size_t index = 0; available < BLEMB_FRAME_HEADER_MAX_SIZE && index < context->fragment_end; index++) {
+        if (index / 8 >= context->fragment_map_size || _blemb_protoh_reliable_has(context, index) == BLEMB_FALSE) break;
+        available += context->fragment_size;
+    }
+    if (available > BLEMB_FRAME_HEADER_MAX_SIZE) available = BLEMB_FRAME_HEADER_MAX_SIZE;
+    if (available == 0 || context->buffer_data[0] != context->magic) return;
+    
+    blemb_size_t message_size = 0;
+    blemb_size_t header_size = 0;
+    if (blemb_frame_read_header(context->format, context->buffer_data, available, &message_size, &header_size) != BLEMB_FRAME_RESULT_COMPLETE) return;
+    
+    // A size that contradicts what was received is left for the final check to reject.
+    blemb_size_t total_size = header_size + message_size + BLEMB_FRAME_TRAILER_SIZE;
+    blemb_size_t fragment_count = (total_size + context->fragment_size - 1) / context->fragment_size;
+    if (total_size > context->buffer_max_size || fragment_count < context->fragment_end) return;
+    if (context->fragment_count > 0 && fragment_count != context->fragment_count) return;
+    
+    context->fragment_count = fragment_count;
+    context->buffer_cur_size = total_size;
+}
+
+void _blemb_protoh_reliable_complete(blemb_protoh_context_t * context) {
+    // Every fragment is in: `buffer_cur_size` is the size of the whole message.
+    blemb_size_t message_size = 0;
+    blemb_size_t header_size = 0;
+    blemb_frame_result_t result = blemb_frame_read_header(context->format, context->buffer_data, context->buffer_cur_size, &message_size, &header_size);
+    
+    blemb_bool_t valid = result == BLEMB_FRAME_RESULT_COMPLETE && context->buffer_data[0] == context->magic ? BLEMB_TRUE : BLEMB_FALSE;
+    if (valid == BLEMB_TRUE && header_size + message_size + BLEMB_FRAME_TRAILER_SIZE != context->buffer_cur_size) valid = BLEMB_FALSE;
+    
+    blemb_buffer_t message = blemb_buffer_init(context->buffer_data + header_size, message_size);
+    if (valid == BLEMB_TRUE && blemb_crc8_compute(message) != context->buffer_data[header_size + message_size]) valid = BLEMB_FALSE;
+    
+    if (valid == BLEMB_FALSE) {
+        // A corrupted fragment got past its own checksum: ask for the whole message again.
+        BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+        _blemb_protoh_reliable_start(context, context->fragment_sequence);
+        return;
+    }
+    
+    // Acknowledged even when the validator refuses it: it did arrive intact.
+    context->fragment_state = _BLEMB_PROTOH_RELIABLE_DONE;
+    _blemb_protoh_deliver_spans(context, message, blemb_buffer_init(NULL, 0));
+    context->buffer_cur_size = 0;
+}
+
+// ---
+// FEC
+// ---
+// Parity fragments wait in `fec_buffer` until their group can be rebuilt. The buffer is
+// cut into slots of `4 + fec_parity_count * fragment_size` bytes, group `g` going to slot
+// `g % slot_count`: the group (2 bytes, 0xFFFF when empty), a mask of the rows in and the
+// count of data fragments in the group, then the rows. A newer group takes the slot over.
+#define _BLEMB_PROTOH_SLOT_HEADER_SIZE 4
+#define _BLEMB_PROTOH_SLOT_EMPTY 0xFFFF
+
+blemb_byte_t * _blemb_protoh_reliable_slot(blemb_protoh_context_t * context, blemb_size_t group, blemb_bool_t claim) {
+    // Returns the slot of `group`, or `NULL` when it holds no parity for it (and `claim` is
+    // `BLEMB_FALSE`) or the buffer can not hold a single slot.
+    blemb_size_t slot_size = _BLEMB_PROTOH_SLOT_HEADER_SIZE + context->fec_parity_count * context->fragment_size;
+    blemb_size_t slot_count = context->fec_buffer_size / slot_size;
+    if (slot_count == 0) return NULL;
+    
+    blemb_byte_t * slot = context->fec_buffer + (group % slot_count) * slot_size;
+    blemb_size_t slot_group = ((blemb_size_t)slot[0] << 8) | slot[1];
+    if (slot_group == group) return slot;
+    if (claim == BLEMB_FALSE) return NULL;
+    
+    slot[0] = (blemb_byte_t)(group >> 8);
+    slot[1] = (blemb_byte_t)group;
+    slot[2] = 0;
+    return slot;
+}
+
+blemb_bool_t _blemb_protoh_reliable_invert(blemb_byte_t matrix[][BLEMB_FRAME_FEC_MAX_PARITY_COUNT], blemb_byte_t inverse[][BLEMB_FRAME_FEC_MAX_PARITY_COUNT], blemb_size_t size) {
+    // Gauss-Jordan elimination in GF(2^8). Every square submatrix of the parity coefficients
+    // is invertible, so this only fails on a broken setup.
+    for (blemb_size_t row = 0; row < size; row++) {
+        for (blemb_size_t column = 0; column < size; column++) {
+            inverse[row][column] = row == column ? 1 : 0;
+        }
+    }
+    
+    for (blemb_size_t column = 0; column < size; column++) {
+        blemb_size_t pivot = column;
+        while (pivot < size && matrix[pivot][column] == 0) pivot++;
+        if (pivot == size) return BLEMB_FALSE;
+        
+        for (blemb_size_t i = 0; i < size; i++) {
+            blemb_byte_t swap = matrix[column][i]; matrix[column][i] = matrix[pivot][i]; matrix[pivot][i] = swap;
+            swap = inverse[column][i]; inverse[column][i] = inverse[pivot][i]; inverse[pivot][i] = swap;
+        }
+        
+        blemb_byte_t scale = blemb_gf256_inv(matrix[column][column]);
+        for (blemb_size_t i = 0; i < size; i++) {
+            matrix[column][i] = blemb_gf256_mul(matrix[column][i], scale);
+            inverse[column][i] = blemb_gf256_mul(inverse[column][i], scale);
+        }
+        
+        for (blemb_size_t row = 0; row < size; row++) {
+            blemb_byte_t factor = matrix[row][column];
+            if (row == column || factor == 0) continue;
+            
+            for (blemb_size_t i = 0; i < size; i++) {
+                matrix[row][i] ^= blemb_gf256_mul(matrix[column][i], factor);
+                inverse[row][i] ^= blemb_gf256_mul(inverse[column][i], factor);
+            }
+        }
+    }
+    
+    return BLEMB_TRUE;
+}
+
+void _blemb_protoh_reliable_rebuild(blemb_protoh_context_t * context, blemb_size_t group) {
+    // Rebuilds the missing fragments of `group` once it has, at least, as many parity rows.
+    blemb_byte_t * slot = _blemb_protoh_reliable_slot(context, group, BLEMB_FALSE);
+    if (slot == NULL || slot[2] == 0) return;
+    
+    // The parity fragments tell the size of the group (see `_blemb_protoh_reliable_parity`).
+    blemb_size_t data_count = context->fec_data_count;
+    blemb_size_t first = group * data_count;
+    blemb_size_t group_size = slot[3];
+    if (context->fragment_count > 0 && first + group_size > context->fragment_count) return;
+    
+    blemb_size_t missing[BLEMB_FRAME_FEC_MAX_PARITY_COUNT];
+    blemb_size_t missing_count = 0;
+    for (blemb_size_t index = first; index < first + group_size; index++) {
+        if (index / 8 >= context->fragment_map_size) return;
+        if (_blemb_protoh_reliable_has(context, index) == BLEMB_TRUE) continue;
+        
+        if (missing_count == context->fec_parity_count) return;
+        missing[missing_count++] = index;
+    }
+    if (missing_count == 0) return;
+    
+    blemb_size_t rows[BLEMB_FRAME_FEC_MAX_PARITY_COUNT];
+    blemb_size_t row_count = 0;
+    for (blemb_size_t row = 0; row < context->fec_parity_count && row_count < missing_count; row++) {
+        if ((slot[2] & (1 << row)) != 0) rows[row_count++] = row;
+    }
+    if (row_count < missing_count) return;
+    
+    // Each row, minus the contribution of the fragments received, only depends on the
+    // missing ones: solve that system.
+    blemb_byte_t matrix[BLEMB_FRAME_FEC_MAX_PARITY_COUNT][BLEMB_FRAME_FEC_MAX_PARITY_COUNT];
+    blemb_byte_t inverse[BLEMB_FRAME_FEC_MAX_PARITY_COUNT][BLEMB_FRAME_FEC_MAX_PARITY_COUNT];
+    for (blemb_size_t r = 0; r < missing_count; r++) {
+        for (blemb_size_t k = 0; k < missing_count; k++) {
+            matrix[r][k] = blemb_frame_parity_coefficient(data_count, rows[r], missing[k] - first);
+        }
+    }
+    if (_blemb_protoh_reliable_invert(matrix, inverse, missing_count) == BLEMB_FALSE) return;
+    
+    blemb_byte_t * syndromes[BLEMB_FRAME_FEC_MAX_PARITY_COUNT];
+    for (blemb_size_t r = 0; r < missing_count; r++) {
+        syndromes[r] = slot + _BLEMB_PROTOH_SLOT_HEADER_SIZE + rows[r] * context->fragment_size;
+        
+        for (blemb_size_t index = first; index < first + group_size; index++) {
+            if (_blemb_protoh_reliable_has(context, index) == BLEMB_FALSE) continue;
+            
+            blemb_byte_t coefficient = blemb_frame_parity_coefficient(data_count, rows[r], index - first);
+            blemb_gf256_mul_add(syndromes[r], context->buffer_data + index * context->fragment_size, coefficient, _blemb_protoh_reliable_length(context, index));
+        }
+    }
+    
+    // Until the message size is known, the last fragment, when missing, is rebuilt with its
+    // zero padding, as far as the buffer goes: the size is then read from the header.
+    for (blemb_size_t k = 0; k < missing_count; k++) {
+        if (missing[k] * context->fragment_size >= context->buffer_max_size) {
+            BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+            return;
+        }
+    }
+    
+    for (blemb_size_t k = 0; k < missing_count; k++) {
+        blemb_byte_t * fragment = context->buffer_data + missing[k] * context->fragment_size;
+        blemb_size_t length = _blemb_protoh_reliable_length(context, missing[k]);
+        if (missing[k] * context->fragment_size + length > context->buffer_max_size) {
+            length = context->buffer_max_size - missing[k] * context->fragment_size;
+        }
+        
+        memset(fragment, 0, length);
+        for (blemb_size_t r = 0; r < missing_count; r++) {
+            blemb_gf256_mul_add(fragment, syndromes[r], inverse[k][r], length);
+        }
+        context->fragment_map[missing[k] / 8] |= (blemb_byte_t)(1 << (missing[k] % 8));
+    }
+    
+    // The rows were used up as scratch space.
+    slot[0] = (blemb_byte_t)(_BLEMB_PROTOH_SLOT_EMPTY >> 8);
+    slot[1] = (blemb_byte_t)_BLEMB_PROTOH_SLOT_EMPTY;
+    
+    context->fragment_received += missing_count;
+    BLEMB_STATS_ADD(context->stats, fragments_recovered, missing_count);
+}
+
+void _blemb_protoh_reliable_rebuild_all(blemb_protoh_context_t * context) {
+    blemb_size_t slot_size = _BLEMB_PROTOH_SLOT_HEADER_SIZE + context->fec_parity_count * context->fragment_size;
+    blemb_size_t slot_count = context->fec_buffer_size / slot_size;
+    
+    for (blemb_size_t i = 0; i < slot_count; i++) {
+        blemb_byte_t * slot = context->fec_buffer + i * slot_size;
+        blemb_size_t group = ((blemb_size_t)slot[0] << 8) | slot[1];
+        if (group == _BLEMB_PROTOH_SLOT_EMPTY) continue;
+        
+        _blemb_protoh_reliable_rebuild(context, group);
+    }
+}
+
+void _blemb_protoh_reliable_retry(blemb_protoh_context_t * context) {
+    // Fragments may come in any order (e.g. striped over several lanes), so any of them may
+    // complete a waiting group, or tell a group is full: every waiting group is tried. Once
+    // the message size is known, from a fragment 0 received or rebuilt, the last group can
+    // be rebuilt too.
+    _blemb_protoh_reliable_rebuild_all(context);
     
-    // If there is no data on the buffer, there is no
-    // candidate to be skipped.
     if (context->buffer_cur_size == 0) {
+        _blemb_protoh_reliable_learn_size(context);
+        if (context->buffer_cur_size > 0) {
+            _blemb_protoh_reliable_rebuild_all(context);
+        }
+    }
+}
+
+blemb_bool_t _blemb_protoh_fec_is_enabled(blemb_protoh_context_t * context) {
+    if (context->fec_parity_count == 0 || context->fec_parity_count > BLEMB_FRAME_FEC_MAX_PARITY_COUNT) return BLEMB_FALSE;
+    if (context->fec_data_count == 0 || context->fec_data_count + BLEMB_FRAME_FEC_MAX_PARITY_COUNT > 256) return BLEMB_FALSE;
+    
+    return context->fec_buffer != NULL ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+void _blemb_protoh_reliable_parity(blemb_protoh_context_t * context, blemb_buffer_t packet, blemb_size_t index) {
+    // Without forward error correction set up, parity fragments are ignored.
+    if (_blemb_protoh_fec_is_enabled(context) == BLEMB_FALSE) return;
+    
+    if (packet.size <= BLEMB_FRAME_PARITY_OVERHEAD) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
         return;
     }
     
-    // If there is one byte only on the buffer, no byte
-    // reallocation is needed. Only buffer cleaning.
-    if (context->buffer_cur_size == 1) {
-        context->buffer_cur_size = 0;
+    blemb_buffer_t parity = blemb_buffer_init(packet.data + BLEMB_FRAME_PARITY_HEADER_SIZE, packet.size - BLEMB_FRAME_PARITY_OVERHEAD);
+    blemb_size_t group = index / context->fec_parity_count;
+    blemb_size_t row = index % context->fec_parity_count;
+    blemb_size_t first = group * context->fec_data_count;
+    
+    // The count of data fragments in the group is below `fec_data_count` only in the last
+    // group: it must agree with what is known of the fragment count.
+    blemb_size_t data_count = packet.data[BLEMB_FRAME_FRAGMENT_HEADER_SIZE];
+    blemb_bool_t consistent = data_count > 0 && data_count <= context->fec_data_count ? BLEMB_TRUE : BLEMB_FALSE;
+    if (first + data_count > BLEMB_FRAME_FRAGMENT_MAX_COUNT) consistent = BLEMB_FALSE;
+    if (context->fragment_count > 0) {
+        if (first >= context->fragment_count) consistent = BLEMB_FALSE;
+        else if (data_count != (context->fragment_count - first < context->fec_data_count ? context->fragment_count - first : context->fec_data_count)) consistent = BLEMB_FALSE;
+    } else if (data_count < context->fec_data_count && first + data_count < context->fragment_end) {
+        consistent = BLEMB_FALSE;
+    }
+    if (context->fragment_size > 0) {
+        blemb_byte_t * held = _blemb_protoh_reliable_slot(context, group, BLEMB_FALSE);
+        if (parity.size != context->fragment_size) consistent = BLEMB_FALSE;
+        else if (held != NULL && held[2] != 0 && held[3] != data_count) consistent = BLEMB_FALSE;
+    }
+    if (consistent == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
         return;
     }
     
-    // If there is more than 2 bytes on the buffer, find
-    // next candidate index.
-    blemb_offset_t next_candidate_offset = 0;
-    for (blemb_offset_t i = 1; i < context->buffer_cur_size; i++) {
-        if (context->buffer_data[i] == context->magic) {
-            next_candidate_offset = i;
-            break;
+    if (context->fragment_size == 0) {
+        context->fragment_size = parity.size;
+        _blemb_protoh_reliable_unpark(context);
+    }
+    
+    if (data_count < context->fec_data_count) {
+        context->fragment_count = first + data_count;
+    }
+    if (first + data_count > context->fragment_end) {
+        context->fragment_end = first + data_count;
+    }
+    
+    blemb_byte_t * slot = _blemb_protoh_reliable_slot(context, group, BLEMB_TRUE);
+    if (slot == NULL) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+        return;
+    }
+    if ((slot[2] & (1 << row)) != 0) return;
+    slot[3] = (blemb_byte_t)data_count;
+    
+    memcpy(slot + _BLEMB_PROTOH_SLOT_HEADER_SIZE + row * context->fragment_size, parity.data, parity.size);
+    slot[2] |= (blemb_byte_t)(1 << row);
+    
+    _blemb_protoh_reliable_retry(context);
+}
+
+// ---------
+// FRAGMENTS
+// ---------
+void _blemb_protoh_reliable_place(blemb_protoh_context_t * context, blemb_buffer_t packet, blemb_size_t index, blemb_bool_t last) {
+    blemb_buffer_t fragment = blemb_buffer_init(packet.data + BLEMB_FRAME_FRAGMENT_HEADER_SIZE, packet.size - BLEMB_FRAME_FRAGMENT_OVERHEAD);
+    
+    // All fragments but the last have the same size, and none comes after the last.
+    blemb_bool_t consistent = BLEMB_TRUE;
+    if (last == BLEMB_FALSE) {
+        if (context->fragment_size > 0 && fragment.size != context->fragment_size) consistent = BLEMB_FALSE;
+        if (context->fragment_count > 0 && index + 1 >= context->fragment_count) consistent = BLEMB_FALSE;
+    } else {
+        if (context->fragment_size > 0 && fragment.size > context->fragment_size) consistent = BLEMB_FALSE;
+        if (index + 1 < context->fragment_end) consistent = BLEMB_FALSE;
+        if (context->fragment_count > 0 && index + 1 != context->fragment_count) consistent = BLEMB_FALSE;
+    }
+    if (consistent == BLEMB_FALSE) {
+        BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+        return;
+    }
+    
+    if (last == BLEMB_TRUE) {
+        context->fragment_count = index + 1;
+    } else if (context->fragment_size == 0) {
+        context->fragment_size = fragment.size;
+        _blemb_protoh_reliable_unpark(context);
+    }
+    
+    if (index + 1 > context->fragment_end) {
+        context->fragment_end = index + 1;
+    }
+    
+    if (index / 8 >= context->fragment_map_size) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+        return;
+    }
+    if (_blemb_protoh_reliable_has(context, index) == BLEMB_TRUE) return;
+    
+    // Only the last fragment can come before the fragment size is known: it waits at the
+    // end of the buffer, out of the way of the others, until a full one tells where it goes.
+    if (index > 0 && context->fragment_size == 0) {
+        if (fragment.size <= context->buffer_max_size) {
+            memcpy(context->buffer_data + context->buffer_max_size - fragment.size, fragment.data, fragment.size);
+            context->fragment_parked = fragment.size;
         }
+        return;
     }
     
-    // If there is no next candidate, no byte reallocation,
-    // is needed. Only buffer cleaning.
-    if (next_candidate_offset == 0) {
-        context->buffer_cur_size = 0;
+    // `index * fragment_size` will not overflow: there are at most `BLEMB_FRAME_FRAGMENT_MAX_COUNT`
+    // fragments and a packet is at most 4096 bytes.
+    blemb_offset_t offset = index * context->fragment_size;
+    if (offset + fragment.size > context->buffer_max_size) {
+        BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
         return;
     }
     
-    // If a candidate is found, we need to reallocate bytes
-    // and update buffer_size_current.
-    uint32_t new_buffer_size = context->buffer_cur_size - next_candidate_offset;
+    memcpy(context->buffer_data + offset, fragment.data, fragment.size);
+    context->fragment_map[index / 8] |= (blemb_byte_t)(1 << (index % 8));
+    context->fragment_received++;
     
-    for (uint32_t index = 0; index < new_buffer_size; index++) {
-        context->buffer_data[index] = context->buffer_data[next_candidate_offset + index];
+    if (last == BLEMB_TRUE) {
+        context->buffer_cur_size = offset + fragment.size;
+    }
+    
+    if (_blemb_protoh_fec_is_enabled(context) == BLEMB_TRUE && context->fragment_size > 0) {
+        _blemb_protoh_reliable_retry(context);
     }
-    context->buffer_cur_size = new_buffer_size;
 }
 
-blemb_bool_t blemb_protoh_handle(blemb_protoh_context_t * context, blemb_buffer_t data) {
+// ---------
+// STREAMING
+// ---------
+// Only the header is buffered. Payload bytes are handed to `on_chunk` straight from
+// the input as they arrive, and checksummed on the way, so a message of any size
+// goes through a 4-byte buffer. A false candidate is only found out at its checksum
+// byte: the bytes it took are not scanned again.
+blemb_bool_t _blemb_protoh_is_streaming(blemb_protoh_context_t * context) {
+    return context->on_chunk != NULL ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+void _blemb_protoh_stream_begin(blemb_protoh_context_t * context, blemb_size_t message_size) {
+    context->parser_encoding = blemb_frame_encoding_size(context->format) > 0 ? _BLEMB_PROTOH_ENCODING_PENDING : BLEMB_FRAME_ENCODING_RAW;
+    
+    if (context->on_begin != NULL) {
+        // The encoding byte is not part of the message.
+        blemb_size_t encoding_size = blemb_frame_encoding_size(context->format);
+        context->on_begin(context, message_size > encoding_size ? message_size - encoding_size : 0);
+    }
+}
+
+void _blemb_protoh_stream_chunk(blemb_protoh_context_t * context, blemb_buffer_t chunk) {
+    // Hands payload bytes over, decoded if need be. The first one of a compressed format
+    // is the encoding byte.
+    if (context->parser_encoding == _BLEMB_PROTOH_ENCODING_PENDING && chunk.size > 0) {
+        context->parser_encoding = chunk.data[0];
+        chunk = blemb_buffer_init(chunk.data + 1, chunk.size - 1);
+        
+        if (context->parser_encoding == BLEMB_FRAME_ENCODING_LZ && context->decompress_data != NULL && context->decompress_max_size > 0) {
+            blemb_lz_decoder_init(&context->decoder, context->compression_dictionary, context->decompress_data, context->decompress_max_size);
+        } else if (context->parser_encoding != BLEMB_FRAME_ENCODING_RAW) {
+            context->parser_encoding = _BLEMB_PROTOH_ENCODING_INVALID;
+        }
+    }
+    
+    if (context->parser_encoding == BLEMB_FRAME_ENCODING_RAW) {
+        if (chunk.size > 0) context->on_chunk(context, chunk);
+        return;
+    }
+    if (context->parser_encoding != BLEMB_FRAME_ENCODING_LZ) return;
+    
+    // Decoded bytes are handed over whenever the window is full, so it never holds more
+    // than its size. A copy may go on once the input is used up.
+    for (;;) {
+        blemb_size_t size = blemb_lz_decode(&context->decoder, chunk);
+        chunk = blemb_buffer_init(chunk.data + size, chunk.size - size);
+        
+        blemb_buffer_t first, second;
+        blemb_lz_decoder_take(&context->decoder, &first, &second);
+        if (first.size > 0) context->on_chunk(context, first);
+        if (second.size > 0) context->on_chunk(context, second);
+        
+        if (first.size == 0 && chunk.size == 0) break;
+    }
+}
+
+blemb_bool_t _blemb_protoh_stream_decoded(blemb_protoh_context_t * context) {
+    // Whether the message that just ended was decoded whole.
+    if (context->parser_encoding == BLEMB_FRAME_ENCODING_RAW) return BLEMB_TRUE;
+    if (context->parser_encoding != BLEMB_FRAME_ENCODING_LZ) return BLEMB_FALSE;
+    
+    return blemb_lz_decoder_is_complete(&context->decoder);
+}
+
+blemb_offset_t _blemb_protoh_stream(blemb_protoh_context_t * context, blemb_buffer_t data) {
+    // Returns the number of bytes taken from `data`, which is all of them.
+    blemb_offset_t offset = 0;
+    
+    while (offset < data.size) {
+        if (context->parser_state == _BLEMB_PROTOH_STATE_SKIP) {
+            offset += _blemb_protoh_skip_input(context, data, offset);
+            continue;
+        }
+        
+        // No candidate: skip garbage straight from the input.
+        if (context->parser_state == _BLEMB_PROTOH_STATE_SEEK) {
+            blemb_offset_t candidate_offset = blemb_scan_find_byte(data, offset, context->magic);
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, candidate_offset - offset);
+            
+            offset = candidate_offset;
+            if (offset >= data.size) break;
+            
+            context->parser_state = _BLEMB_PROTOH_STATE_HEADER;
+        }
+        
+        if (context->parser_state == _BLEMB_PROTOH_STATE_HEADER) {
+            blemb_size_t size = _blemb_protoh_header_bytes_needed(context, 0);
+            if (size > data.size - offset) {
+                size = data.size - offset;
+            }
+            
+            _blemb_protoh_storage_append(context, data.data + offset, size);
+            offset += size;
+            
+            blemb_size_t message_size = 0;
+            blemb_size_t header_size = 0;
+            blemb_frame_result_t result = _blemb_protoh_read_header(context, 0, &message_size, &header_size);
+            if (result == BLEMB_FRAME_RESULT_INCOMPLETE) {
+                continue;
+            }
+            
+            if (result == BLEMB_FRAME_RESULT_INVALID) {
+                // Drop the magic byte and parse the other buffered header bytes again, as
+                // if they had just arrived. Each level has fewer bytes, so this is shallow.
+                blemb_byte_t pending[BLEMB_FRAME_HEADER_MAX_SIZE];
+                blemb_size_t pending_size = context->buffer_cur_size - 1;
+                _blemb_protoh_storage_copy(context, 1, pending, pending_size);
+                
+                BLEMB_STATS_ADD(context->stats, header_rejects, 1);
+                BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, 1);
+                _blemb_protoh_discard(context, context->buffer_cur_size);
+                _blemb_protoh_stream(context, blemb_buffer_init(pending, pending_size));
+                continue;
+            }
+            
+            if (_blemb_protoh_header_accepted(context, message_size) == BLEMB_FALSE) {
+                // Only the header is buffered, the rest is dropped from the input.
+                _blemb_protoh_skip_message(context, message_size);
+                continue;
+            }
+            
+            context->parser_state = _BLEMB_PROTOH_STATE_BODY;
+            context->parser_offset = 0;
+            context->parser_length = message_size;
+            context->parser_crc = blemb_crc8_init();
+            
+            _blemb_protoh_stream_begin(context, message_size);
+            continue;
+        }
+        
+        // Forward the payload bytes of this call, `parser_offset` counts those already forwarded.
+        if (context->parser_offset < context->parser_length) {
+            blemb_size_t size = context->parser_length - context->parser_offset;
+            if (size > data.size - offset) {
+                size = data.size - offset;
+            }
+            
+            blemb_buffer_t chunk = blemb_buffer_init(data.data + offset, size);
+            context->parser_crc = blemb_crc8_update(context->parser_crc, chunk);
+            context->parser_offset += size;
+            offset += size;
+            
+            _blemb_protoh_stream_chunk(context, chunk);
+            continue;
+        }
+        
+        blemb_bool_t crc_ok = data.data[offset] == blemb_crc8_final(context->parser_crc) ? BLEMB_TRUE : BLEMB_FALSE;
+        offset += 1;
+        
+        if (crc_ok == BLEMB_FALSE) {
+            BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+        } else if (_blemb_protoh_stream_decoded(context) == BLEMB_FALSE) {
+            BLEMB_STATS_ADD(context->stats, decompress_failures, 1);
+            crc_ok = BLEMB_FALSE;
+        } else {
+            BLEMB_STATS_ADD(context->stats, messages_delivered, 1);
+        }
+        
+        // Drop the header, which also resets the parser.
+        _blemb_protoh_discard(context, context->buffer_cur_size);
+        
+        if (context->on_end != NULL) {
+            context->on_end(context, crc_ok);
+        }
+    }
+    
+    return offset;
+}
+
+blemb_bool_t _blemb_protoh_is_valid(blemb_protoh_context_t * context) {
     if (context == NULL) return BLEMB_FALSE;
     
-    // To free up space before adding more data, attempt to deliver
-    // all pending messages.
-    while (_blemb_protoh_process_next_message(context) == BLEMB_TRUE) { }
+    // The buffer must be able to hold, at least, an empty message and any header.
+    if (context->buffer_data == NULL) return BLEMB_FALSE;
+    if (blemb_frame_is_valid(context->format) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (context->buffer_max_size < _blemb_protoh_message_size(context, 0)) return BLEMB_FALSE;
+    if (context->buffer_max_size < blemb_frame_header_size(context->format, blemb_frame_max_payload_size(context->format))) return BLEMB_FALSE;
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t _blemb_protoh_handle(blemb_protoh_context_t * context, blemb_buffer_t data, blemb_size_t work_budget, blemb_size_t * consumed) {
+    if (consumed != NULL) *consumed = 0;
+    
+    if (_blemb_protoh_is_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    if (blemb_buffer_is_empty(data) == BLEMB_TRUE) return BLEMB_TRUE;
+    
+    if (_blemb_protoh_is_streaming(context) == BLEMB_TRUE) {
+        // Every byte costs one step: the budget only limits how many are taken.
+        if (work_budget > 0 && data.size > work_budget) {
+            data.size = work_budget;
+        }
         
-    // If the input data exceeds the maximum processable size, return
-    // an error indicating it can't be processed.
-    if (data.size > context->buffer_max_size) {
-        return BLEMB_FALSE;
+        blemb_offset_t streamed = _blemb_protoh_stream(context, data);
+        BLEMB_STATS_ADD(context->stats, bytes_ingested, streamed);
+        
+        if (consumed != NULL) *consumed = streamed;
+        return BLEMB_TRUE;
     }
     
-    // If there's no space to store the received data, skip the
-    // unprocessed data.
-    blemb_size_t available_space = context->buffer_max_size - context->buffer_cur_size;
-    if (data.size > available_space) {
-        _blemb_protoh_skip_current_candidate(context);
+    blemb_bool_t bounded = _blemb_protoh_is_bounded(context);
+    blemb_size_t work = 0;
+    
+    blemb_offset_t offset = 0;
+    while (offset < data.size) {
+        if (work_budget > 0 && work >= work_budget) break;
+        
+        // Bytes of a message refused at its header are dropped unseen.
+        if (context->parser_state == _BLEMB_PROTOH_STATE_SKIP) {
+            offset += _blemb_protoh_skip_input(context, data, offset);
+            continue;
+        }
         
-        return blemb_protoh_handle(context, data);
+        // While there is no candidate, skip garbage straight from the input
+        // instead of buffering it.
+        if (context->buffer_cur_size == 0) {
+            blemb_buffer_t input = data;
+            if (work_budget > 0 && input.size - offset > work_budget - work) {
+                input.size = offset + (work_budget - work);
+            }
+            
+            blemb_offset_t candidate_offset = blemb_scan_find_byte(input, offset, context->magic);
+            BLEMB_STATS_ADD(context->stats, resync_discarded_bytes, candidate_offset - offset);
+            
+            work += candidate_offset - offset;
+            offset = candidate_offset;
+            if (offset >= input.size) continue;
+            
+            if (bounded == BLEMB_FALSE) {
+                blemb_size_t work_left = work_budget > 0 ? work_budget - work : data.size;
+                blemb_size_t taken = _blemb_protoh_direct(context, data, offset, work_left, &work);
+                if (taken > 0) {
+                    offset += taken;
+                    continue;
+                }
+            }
+        }
+        
+        // Buffer only the bytes the current candidate needs. Every byte is
+        // looked at once: state is kept in the context between calls.
+        // `data.size - offset` will not underflow, as guaranteed by the while condition.
+        blemb_size_t size = _blemb_protoh_bytes_needed(context);
+        if (size > data.size - offset) {
+            size = data.size - offset;
+        }
+        
+        // With a budget, take only the bytes it can pay for. In bounded mode every
+        // new byte costs, at most, one scan plus one step per tracked candidate.
+        if (work_budget > 0) {
+            blemb_size_t step_cost = bounded == BLEMB_TRUE ? context->candidate_max_count + 1 : 1;
+            blemb_size_t affordable = (work_budget - work) / step_cost;
+            if (affordable == 0) affordable = 1;
+            if (size > affordable) size = affordable;
+        }
+        
+        // Defensive: `_blemb_protoh_bytes_needed` never exceeds the available space.
+        blemb_size_t available_space = context->buffer_max_size - context->buffer_cur_size;
+        if (available_space == 0) {
+            BLEMB_STATS_ADD(context->stats, overflow_skips, 1);
+            if (bounded == BLEMB_TRUE) {
+                _blemb_protoh_bounded_reject_first(context);
+                work += _blemb_protoh_bounded_process(context);
+            } else {
+                _blemb_protoh_skip_current_candidate(context);
+                work += _blemb_protoh_process(context);
+            }
+            continue;
+        }
+        if (size > available_space) {
+            size = available_space;
+        }
+        
+        _blemb_protoh_storage_append(context, data.data + offset, size);
+        offset += size;
+        
+        // Advance the parser over the new bytes, delivering any completed message.
+        work += bounded == BLEMB_TRUE ? _blemb_protoh_bounded_process(context) : _blemb_protoh_process(context);
     }
     
-    // Write the received data to the buffer.
-    for (blemb_offset_t offset = 0; offset < data.size; offset++) {
-        context->buffer_data[context->buffer_cur_size + offset] = data.data[offset];
+    BLEMB_STATS_ADD(context->stats, bytes_ingested, offset);
+    
+    if (consumed != NULL) *consumed = offset;
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protoh_handle(blemb_protoh_context_t * context, blemb_buffer_t data) {
+    return _blemb_protoh_handle(context, data, 0, NULL);
+}
+
+blemb_bool_t blemb_protoh_handle_partial(blemb_protoh_context_t * context, blemb_buffer_t data, blemb_size_t * consumed) {
+    if (context == NULL) return BLEMB_FALSE;
+    
+    return _blemb_protoh_handle(context, data, context->work_budget, consumed);
+}
+
+void _blemb_protoh_window_span(blemb_protoh_context_t * context, blemb_buffer_t * window) {
+    _blemb_protoh_storage_free_span(context, window);
+    
+    // Bounded mode takes only the bytes the first candidate needs, as `blemb_protoh_handle`
+    // does: a larger block could hold more message starts than there are candidates.
+    if (_blemb_protoh_is_bounded(context) == BLEMB_TRUE) {
+        blemb_size_t needed = context->parser_state == _BLEMB_PROTOH_STATE_SKIP ? context->parser_length : _blemb_protoh_bytes_needed(context);
+        if (window->size > needed) window->size = needed;
     }
-    context->buffer_cur_size += data.size;
+}
+
+blemb_bool_t blemb_protoh_window(blemb_protoh_context_t * context, blemb_buffer_t * window) {
+    if (window == NULL) return BLEMB_FALSE;
+    *window = blemb_buffer_init(NULL, 0);
     
-    // After adding the received data, attempt to deliver all pending messages.
-    while (_blemb_protoh_process_next_message(context) == BLEMB_TRUE) { }
+    if (_blemb_protoh_is_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (_blemb_protoh_is_streaming(context) == BLEMB_TRUE) return BLEMB_FALSE;
     
+    // Linear mode: move the pending bytes, at most one partial message, to the start
+    // so the whole free space is contiguous.
+    if (context->buffer_ring == BLEMB_FALSE && context->buffer_head > 0) {
+        memmove(context->buffer_data, context->buffer_data + context->buffer_head, context->buffer_cur_size);
+        context->buffer_head = 0;
+    }
+    
+    _blemb_protoh_window_span(context, window);
     return BLEMB_TRUE;
 }
+
+blemb_bool_t blemb_protoh_commit(blemb_protoh_context_t * context, blemb_size_t size) {
+    if (_blemb_protoh_is_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (_blemb_protoh_is_streaming(context) == BLEMB_TRUE) return BLEMB_FALSE;
+    
+    blemb_buffer_t window;
+    _blemb_protoh_window_span(context, &window);
+    if (size > window.size) return BLEMB_FALSE;
+    
+    context->buffer_cur_size += size;
+    BLEMB_STATS_ADD(context->stats, bytes_ingested, size);
+    
+    // Bytes of a message refused at its header are dropped. Nothing else is buffered then.
+    if (context->parser_state == _BLEMB_PROTOH_STATE_SKIP) {
+        blemb_size_t skipped = context->buffer_cur_size < context->parser_length ? context->buffer_cur_size : context->parser_length;
+        blemb_size_t remaining = context->parser_length - skipped;
+        
+        _blemb_protoh_discard(context, skipped);
+        if (remaining > 0) {
+            context->parser_state = _BLEMB_PROTOH_STATE_SKIP;
+            context->parser_length = remaining;
+            return BLEMB_TRUE;
+        }
+    }
+    
+    if (_blemb_protoh_is_bounded(context) == BLEMB_TRUE) {
+        _blemb_protoh_bounded_process(context);
+    } else {
+        // Without a candidate, the parser looks for one among the new bytes.
+        _blemb_protoh_process(context);
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_size_t blemb_protoh_bytes_needed(blemb_protoh_context_t * context) {
+    if (context == NULL) return 0;
+    
+    // Nothing is buffered while a refused message is dropped.
+    if (context->parser_state == _BLEMB_PROTOH_STATE_SKIP) {
+        return context->parser_length < context->buffer_max_size ? context->parser_length : context->buffer_max_size;
+    }
+    
+    if (_blemb_protoh_is_streaming(context) == BLEMB_TRUE) {
+        switch (context->parser_state) {
+            case _BLEMB_PROTOH_STATE_HEADER:
+                return _blemb_protoh_header_bytes_needed(context, 0);
+            case _BLEMB_PROTOH_STATE_BODY:
+                return context->parser_length - context->parser_offset + BLEMB_FRAME_TRAILER_SIZE;
+            default:
+                return 1;
+        }
+    }
+    
+    return _blemb_protoh_bytes_needed(context);
+}
+
+blemb_bool_t blemb_protoh_handle_reliable(blemb_protoh_context_t * context, blemb_buffer_t packet) {
+    if (_blemb_protoh_is_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (context->fragment_map == NULL || context->fragment_map_size == 0) return BLEMB_FALSE;
+    if (packet.data == NULL) return BLEMB_FALSE;
+    
+    BLEMB_STATS_ADD(context->stats, bytes_ingested, packet.size);
+    
+    blemb_uint8_t sequence = 0;
+    blemb_uint16_t index = 0;
+    blemb_uint16_t flags = 0;
+    if (blemb_frame_read_fragment(packet, &sequence, &index, &flags) != BLEMB_FRAME_RESULT_COMPLETE) {
+        // Dropped: the next report lists it as missing.
+        BLEMB_STATS_ADD(context->stats, crc_mismatches, 1);
+        return BLEMB_TRUE;
+    }
+    
+    // Sequences wrap around: compare them with serial number arithmetic. Older ones are late
+    // duplicates (e.g. from a slower lane) of messages already acknowledged, and fragments
+    // of the message just delivered are resent ones: its acknowledgement was lost. Only a
+    // newer sequence is a new message, the sender moves on after an acknowledgement.
+    blemb_int8_t age = (blemb_int8_t)(blemb_uint8_t)(sequence - context->fragment_sequence);
+    if (context->fragment_state != _BLEMB_PROTOH_RELIABLE_IDLE) {
+        if (age < 0) return BLEMB_TRUE;
+        if (age == 0 && context->fragment_state == _BLEMB_PROTOH_RELIABLE_DONE) return BLEMB_TRUE;
+    }
+    
+    if (context->fragment_state == _BLEMB_PROTOH_RELIABLE_IDLE || age > 0) {
+        _blemb_protoh_reliable_start(context, sequence);
+    }
+    
+    if ((flags & BLEMB_FRAME_FRAGMENT_PARITY) != 0) {
+        _blemb_protoh_reliable_parity(context, packet, index);
+    } else {
+        _blemb_protoh_reliable_place(context, packet, index, (flags & BLEMB_FRAME_FRAGMENT_LAST) != 0 ? BLEMB_TRUE : BLEMB_FALSE);
+    }
+    
+    // A rebuilt fragment may have been the last one missing.
+    if (context->fragment_state == _BLEMB_PROTOH_RELIABLE_RECEIVING && context->fragment_count > 0 && context->fragment_received == context->fragment_count) {
+        _blemb_protoh_reliable_complete(context);
+    }
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protoh_reliable_report(blemb_protoh_context_t * context, blemb_buffer_t report, blemb_size_t * report_size) {
+    if (report_size == NULL) return BLEMB_FALSE;
+    *report_size = 0;
+    
+    if (context == NULL || context->fragment_map == NULL) return BLEMB_FALSE;
+    if (report.data == NULL || report.size < 1 + 2) return BLEMB_FALSE;
+    if (context->fragment_state == _BLEMB_PROTOH_RELIABLE_IDLE) return BLEMB_FALSE;
+    
+    report.data[0] = context->fragment_sequence;
+    blemb_size_t size = 1;
+    if (context->fragment_state == _BLEMB_PROTOH_RELIABLE_DONE) {
+        *report_size = size;
+        return BLEMB_TRUE;
+    }
+    
+    // While the last fragment is unknown, everything past the highest one seen is missing
+    // too: room is kept for that entry.
+    blemb_size_t end = context->fragment_count > 0 ? context->fragment_count : context->fragment_end;
+    blemb_size_t entry_max_count = (report.size - 1) / 2;
+    if (context->fragment_count == 0) entry_max_count--;
+    
+    for (blemb_size_t index = 0; index < end && (size - 1) / 2 < entry_max_count; index++) {
+        if (index / 8 < context->fragment_map_size && _blemb_protoh_reliable_has(context, index) == BLEMB_TRUE) continue;
+        
+        report.data[size++] = (blemb_byte_t)(index >> 8);
+        report.data[size++] = (blemb_byte_t)index;
+    }
+    
+    if (context->fragment_count == 0) {
+        blemb_uint16_t entry = (blemb_uint16_t)(context->fragment_end | BLEMB_FRAME_REPORT_FROM);
+        report.data[size++] = (blemb_byte_t)(entry >> 8);
+        report.data[size++] = (blemb_byte_t)entry;
+    }
+    
+    *report_size = size;
+    return BLEMB_TRUE;
+}
+
+void blemb_protoh_stats_snapshot(blemb_protoh_context_t * context, blemb_protoh_stats_t * snapshot) {
+    if (snapshot == NULL) return;
+    
+    if (context == NULL || context->stats == NULL) {
+        memset(snapshot, 0, sizeof(*snapshot));
+        return;
+    }
+    
+    *snapshot = *context->stats;
+}
+
+void blemb_protoh_stats_reset(blemb_protoh_context_t * context) {
+    if (context == NULL || context->stats == NULL) return;
+    
+    memset(context->stats, 0, sizeof(*context->stats));
+}
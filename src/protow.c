@@ -7,97 +7,684 @@
 
 // STDLIB
 #include <stddef.h>
+#include <string.h>
 
 // PUBLIC
 #include <blemb/types.h>
 #include <blemb/buffer.h>
+#include <blemb/crc8.h>
+#include <blemb/frame.h>
+#include <blemb/lz.h>
 #include <blemb/protow.h>
 
 // PRIVATE
-#include <blemb_binary.h>
 #include <blemb_buffer.h>
 #include <blemb_crc8.h>
+#include <blemb_frame.h>
+#include <blemb_gf256.h>
+#include <blemb_stats.h>
 
-blemb_bool_t _blemb_protow_write_message(blemb_byte_t magic, blemb_uint16_t mtu, blemb_buffer_t payload, blemb_protow_writer_f writer) {
-    // TODO: Optimize memory usage in _blemb_protow_write_message.
-    // Instead of copying the entire message into a new buffer, we can call the writer directly using the payload buffer.
-    // The first writer call must copy the first packet (as it includes the magic byte, payload size, and the start of the payload),
-    // and the last call must copy the final packet (as it includes the end of the payload and the CRC).
-    // Intermediate writer calls can directly use slices of the payload buffer.
+blemb_buffer_t _blemb_protow_slice_part(blemb_buffer_t part, blemb_offset_t part_offset, blemb_offset_t start, blemb_offset_t end) {
+    // Returns the bytes of `part` (placed at `part_offset` within the message) that
+    // fall inside the message range [`start`, `end`).
+    blemb_offset_t part_end = part_offset + part.size;
+    blemb_offset_t from = start > part_offset ? start : part_offset;
+    blemb_offset_t to = end < part_end ? end : part_end;
     
+    if (from >= to) {
+        return blemb_buffer_init(part.data, 0);
+    }
+    
+    return blemb_buffer_init(part.data + (from - part_offset), to - from);
+}
+
+blemb_bool_t _blemb_protow_iterator_init_encoded(blemb_protow_iterator_t * iterator, blemb_byte_t magic, blemb_frame_format_t format, blemb_uint16_t mtu, blemb_buffer_t payload, blemb_byte_t encoding, blemb_protow_stats_t * stats) {
     // MTU must be at least 1 byte (e.g., MTU 0 is invalid) since we can't split data into packets smaller than 1 byte.
     // We also enforce a maximum MTU of 4096 to prevent potential overflows in the system.
     // Do not remove this limit — the source code does not support larger MTUs and doing so may cause memory overflows.
     if (mtu < 1 || mtu > 4096) return BLEMB_FALSE;
     
-    if (writer == NULL) return BLEMB_FALSE;
+    if (blemb_frame_is_valid(format) == BLEMB_FALSE) return BLEMB_FALSE;
     
-    // Make sure the payload fits in the proto message.
-    if (payload.size > BLEMB_UINT16_MAX) return BLEMB_FALSE;
-    blemb_uint16_t payload_size = (blemb_uint16_t)payload.size;
+    // Make sure the payload, and its encoding byte in a compressed format, fits in the proto message.
+    blemb_size_t encoding_size = blemb_frame_encoding_size(format);
+    if (payload.size > blemb_frame_max_payload_size(format) - encoding_size) return BLEMB_FALSE;
+    if (payload.data == NULL && payload.size > 0) return BLEMB_FALSE;
     
-    // Calculate the message size based on the payload size.
-    // This will never overflow because `payload_size` has a maximum value of `UINT16_MAX`,
-    // and `4 + UINT16_MAX` easily fits within a 32-bit integer.
-    blemb_size_t message_size = 4 + payload_size;
+    // The payload is never copied as a whole. The message is described as three parts:
+    // the header, the caller's payload and the trailer. Each packet is a range of the
+    // message, made of a slice of each part. The encoding byte goes with the header.
+    iterator->header_size = (blemb_uint8_t)blemb_frame_write_header(format, magic, payload.size + encoding_size, iterator->header);
     
     // Compute payload checksum.
-    blemb_byte_t checksum = blemb_crc8_compute(payload);
+    blemb_byte_t crc = blemb_crc8_init();
+    if (encoding_size > 0) {
+        iterator->header[iterator->header_size] = encoding;
+        crc = blemb_crc8_update(crc, blemb_buffer_init(iterator->header + iterator->header_size, encoding_size));
+        iterator->header_size += encoding_size;
+    }
+    iterator->trailer[0] = blemb_crc8_final(blemb_crc8_update(crc, payload));
     
-    // To support platforms without dynamic memory allocation (e.g., no malloc),
-    // we create a buffer that's only used during transmission.
-    blemb_byte_t message_data[message_size];
-    blemb_buffer_t message_buffer = blemb_buffer_init(message_data, message_size);
+    iterator->payload = payload;
+    iterator->mtu = mtu;
+    iterator->stats = stats;
+    iterator->offset = 0;
     
-    // Write packet magic byte to buffer.
-    if (blemb_binary_write_byte(message_buffer, 0, magic) != BLEMB_BINARY_RESULT_SUCCESS) return BLEMB_FALSE;
+    // Calculate the message size based on the payload size.
+    // This will never overflow because the payload size has a maximum value of
+    // `BLEMB_FRAME_V2_MAX_PAYLOAD_SIZE` (2^28 - 1), and the header adds at most 7 bytes.
+    iterator->message_size = iterator->header_size + payload.size + BLEMB_FRAME_TRAILER_SIZE;
     
-    // Write packet payload size to buffer.
-    if (blemb_binary_write_uint16(message_buffer, 1, BLEMB_BINARY_ENDIANNESS_BIG, payload_size) != BLEMB_BINARY_RESULT_SUCCESS) return BLEMB_FALSE;
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t _blemb_protow_iterator_init(blemb_protow_iterator_t * iterator, blemb_byte_t magic, blemb_frame_format_t format, blemb_uint16_t mtu, blemb_buffer_t payload, blemb_protow_stats_t * stats) {
+    return _blemb_protow_iterator_init_encoded(iterator, magic, format, mtu, payload, BLEMB_FRAME_ENCODING_RAW, stats);
+}
+
+blemb_size_t _blemb_protow_iterator_peek(blemb_protow_iterator_t * iterator) {
+    // Size of the next packet, zero once the whole message has been emitted.
+    if (iterator->offset >= iterator->message_size) return 0;
     
-    // Write packet payload to buffer.
-    if (blemb_binary_write_buffer(message_buffer, 3, payload) != BLEMB_BINARY_RESULT_SUCCESS) return BLEMB_FALSE;
-        
-    // Write checksum to buffer.
-    if (blemb_binary_write_byte(message_buffer, 3 + payload_size, checksum) != BLEMB_BINARY_RESULT_SUCCESS) return BLEMB_FALSE;
+    // `offset + mtu` will never overflow.
+    // This is guaranteed because `offset` is always less than `message_size` (checked above),
+    // and `message_size` is at most `6 + payload_size`. Since `payload_size` has a maximum of 2^28 - 1,
+    // the maximum possible value for `offset` is `5 + 2^28`.
+    // Additionally, `mtu` is limited to a maximum of 4096 (enforced when the iterator is initialized).
+    // Therefore, the worst-case value for `offset + mtu` is `5 + 2^28 + 4096`,
+    // which safely fits within a 32-bit integer.
+    if (iterator->offset + iterator->mtu <= iterator->message_size) {
+        return iterator->mtu;
+    }
+    
+    // `message_size - offset` will not underflow, as this is guaranteed by the check above.
+    return iterator->message_size - iterator->offset;
+}
+
+void _blemb_protow_iterator_slice(blemb_protow_iterator_t * iterator, blemb_size_t size, blemb_buffer_t * head, blemb_buffer_t * body, blemb_buffer_t * tail) {
+    // Describes the next `size` message bytes as slices of the header, payload and trailer,
+    // and moves past them. `size` never exceeds the bytes left.
+    blemb_buffer_t header = blemb_buffer_init(iterator->header, iterator->header_size);
+    blemb_buffer_t trailer = blemb_buffer_init(iterator->trailer, sizeof(iterator->trailer));
+    
+    blemb_offset_t offset = iterator->offset;
+    blemb_offset_t end = offset + size;
+    *head = _blemb_protow_slice_part(header, 0, offset, end);
+    *body = _blemb_protow_slice_part(iterator->payload, iterator->header_size, offset, end);
+    *tail = _blemb_protow_slice_part(trailer, iterator->header_size + iterator->payload.size, offset, end);
+    
+    // Same bound as `offset + mtu` in `_blemb_protow_iterator_peek`: it safely fits in a 32-bit integer.
+    iterator->offset = end;
+}
+
+blemb_size_t _blemb_protow_iterator_advance(blemb_protow_iterator_t * iterator, blemb_buffer_t * head, blemb_buffer_t * body, blemb_buffer_t * tail) {
+    // Describes the next packet and moves past it. Returns its size, zero once the whole
+    // message has been emitted.
+    blemb_size_t packet_size = _blemb_protow_iterator_peek(iterator);
+    if (packet_size == 0) return 0;
+    
+    _blemb_protow_iterator_slice(iterator, packet_size, head, body, tail);
+    
+    BLEMB_STATS_ADD(iterator->stats, packets_emitted, 1);
+    BLEMB_STATS_ADD(iterator->stats, bytes_emitted, packet_size);
+    if (iterator->offset == iterator->message_size) {
+        BLEMB_STATS_ADD(iterator->stats, messages_written, 1);
+    }
+    
+    return packet_size;
+}
+
+void _blemb_protow_gather(blemb_byte_t * packet_data, blemb_buffer_t head, blemb_buffer_t body, blemb_buffer_t tail) {
+    // `head.size + body.size + tail.size` is the packet size, which never exceeds the destination.
+    memcpy(packet_data, head.data, head.size);
+    if (body.size > 0) {
+        memcpy(packet_data + head.size, body.data, body.size);
+    }
+    memcpy(packet_data + head.size + body.size, tail.data, tail.size);
+}
+
+blemb_bool_t _blemb_protow_write_message(blemb_byte_t magic, blemb_frame_format_t format, blemb_uint16_t mtu, blemb_buffer_t payload, blemb_byte_t encoding, blemb_protow_writer_f writer, blemb_protow_gather_writer_f gather_writer, blemb_protow_stats_t * stats) {
+    if (writer == NULL && gather_writer == NULL) return BLEMB_FALSE;
+    
+    blemb_protow_iterator_t iterator;
+    if (_blemb_protow_iterator_init_encoded(&iterator, magic, format, mtu, payload, encoding, stats) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    // Packets holding header or trailer bytes (at most the first and the last ones) are staged
+    // in this MTU-sized buffer when the writer is not a gather one. Middle packets are slices
+    // of the payload.
+    blemb_byte_t packet_data[gather_writer != NULL ? 1 : mtu];
     
     // Call writer
-    blemb_offset_t offset = 0;
-    while (offset < message_buffer.size) {
-        blemb_size_t packet_size;
+    blemb_buffer_t head, body, tail;
+    blemb_size_t packet_size;
+    while ((packet_size = _blemb_protow_iterator_advance(&iterator, &head, &body, &tail)) > 0) {
+        if (gather_writer != NULL) {
+            gather_writer(head, body, tail);
+        } else if (head.size == 0 && tail.size == 0) {
+            writer(body);
+        } else {
+            _blemb_protow_gather(packet_data, head, body, tail);
+            writer(blemb_buffer_init(packet_data, packet_size));
+        }
+    }
+    
+    return BLEMB_TRUE;
+}
+
+// --------
+// BATCHING
+// --------
+// The message stream is cut into packets of exactly `mtu` bytes, regardless of message
+// boundaries. Only the last, partial packet is staged in `batch_data`: it is topped up
+// by the next message, and whole packets in between are emitted straight from the
+// payload, as in `_blemb_protow_write_message`.
+void _blemb_protow_batch_emit(blemb_protow_context_t * context) {
+    if (context->batch_size == 0) return;
+    
+    BLEMB_STATS_ADD(context->stats, packets_emitted, 1);
+    BLEMB_STATS_ADD(context->stats, bytes_emitted, context->batch_size);
+    
+    blemb_buffer_t packet = blemb_buffer_init(context->batch_data, context->batch_size);
+    context->batch_size = 0;
+    if (context->gather_writer != NULL) {
+        context->gather_writer(packet, blemb_buffer_init(packet.data, 0), blemb_buffer_init(packet.data, 0));
+    } else {
+        context->writer(packet);
+    }
+}
+
+void _blemb_protow_batch_stage(blemb_protow_context_t * context, blemb_protow_iterator_t * iterator, blemb_size_t size) {
+    blemb_buffer_t head, body, tail;
+    _blemb_protow_iterator_slice(iterator, size, &head, &body, &tail);
+    _blemb_protow_gather(context->batch_data + context->batch_size, head, body, tail);
+    context->batch_size += (blemb_uint16_t)size;
+}
+
+blemb_bool_t _blemb_protow_write_batched(blemb_protow_context_t * context, blemb_buffer_t payload, blemb_byte_t encoding) {
+    if (context->writer == NULL && context->gather_writer == NULL) return BLEMB_FALSE;
+    
+    // Counters are updated here, as packets are not those of the iterator.
+    blemb_protow_iterator_t iterator;
+    if (_blemb_protow_iterator_init_encoded(&iterator, context->magic, context->format, context->mtu, payload, encoding, NULL) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    // Top up the pending packet. Either it gets full or the message ends in it.
+    if (context->batch_size > 0) {
+        blemb_size_t size = context->mtu - context->batch_size;
+        if (size > iterator.message_size) {
+            size = iterator.message_size;
+        }
+        
+        _blemb_protow_batch_stage(context, &iterator, size);
+        if (context->batch_size == context->mtu) {
+            _blemb_protow_batch_emit(context);
+        }
+    }
+    
+    // Whole packets. The staging buffer is empty here, so it can hold header and trailer bytes.
+    blemb_buffer_t head, body, tail;
+    while (iterator.message_size - iterator.offset >= context->mtu) {
+        _blemb_protow_iterator_slice(&iterator, context->mtu, &head, &body, &tail);
+        BLEMB_STATS_ADD(context->stats, packets_emitted, 1);
+        BLEMB_STATS_ADD(context->stats, bytes_emitted, context->mtu);
         
-        // `offset + mtu` will never overflow.
-        // This is guaranteed because `offset` is always less than `message_buffer.size` (enforced by the while loop),
-        // and `message_buffer.size` is at most `4 + payload_size`. Since `payload_size` has a maximum of `UINT16_MAX`,
-        // the maximum possible value for `offset` is `4 + UINT16_MAX`.
-        // Additionally, `mtu` is limited to a maximum of 4096 (enforced by a pre-check).
-        // Therefore, the worst-case value for `offset + mtu` is `4 + UINT16_MAX + 4096`,
-        // which safely fits within a 32-bit integer.
-        if (offset + mtu <= message_buffer.size) {
-            packet_size = mtu;
+        if (context->gather_writer != NULL) {
+            context->gather_writer(head, body, tail);
+        } else if (head.size == 0 && tail.size == 0) {
+            context->writer(body);
         } else {
-            // `message_buffer.size - offset` will not underflow, as this is guaranteed by the while condition.
-            packet_size = message_buffer.size - offset;
+            _blemb_protow_gather(context->batch_data, head, body, tail);
+            context->writer(blemb_buffer_init(context->batch_data, context->mtu));
+        }
+    }
+    
+    // Stage the rest, for the next message to complete.
+    if (iterator.offset < iterator.message_size) {
+        _blemb_protow_batch_stage(context, &iterator, iterator.message_size - iterator.offset);
+    }
+    BLEMB_STATS_ADD(context->stats, messages_written, 1);
+    
+    if (context->batch_threshold > 0 && context->batch_size >= context->batch_threshold) {
+        _blemb_protow_batch_emit(context);
+    }
+    
+    return BLEMB_TRUE;
+}
+
+// -----
+// QUEUE
+// -----
+// Queued messages keep their iterator, so a packet refused by `try_writer` is simply
+// described again from the same offset on the next pump. Nothing is copied ahead.
+blemb_bool_t _blemb_protow_queue_send(blemb_protow_context_t * context, blemb_protow_iterator_t * iterator, blemb_buffer_t prefix) {
+    // Offers the next packet of `iterator`, after the `prefix` bytes (the stream index in
+    // multiplexed mode, nothing otherwise). Returns `BLEMB_FALSE` when it was refused.
+    blemb_size_t message_bytes = _blemb_protow_iterator_peek(iterator);
+    blemb_size_t packet_size = prefix.size + message_bytes;
+    blemb_offset_t offset = iterator->offset;
+    
+    blemb_buffer_t head, body, tail;
+    _blemb_protow_iterator_slice(iterator, message_bytes, &head, &body, &tail);
+    
+    blemb_protow_result_t result;
+    if (prefix.size == 0 && head.size == 0 && tail.size == 0) {
+        result = context->try_writer(context, body);
+    } else {
+        blemb_byte_t packet_data[packet_size];
+        memcpy(packet_data, prefix.data, prefix.size);
+        _blemb_protow_gather(packet_data + prefix.size, head, body, tail);
+        result = context->try_writer(context, blemb_buffer_init(packet_data, packet_size));
+    }
+    
+    if (result == BLEMB_PROTOW_WOULD_BLOCK) {
+        iterator->offset = offset;
+        return BLEMB_FALSE;
+    }
+    
+    BLEMB_STATS_ADD(context->stats, packets_emitted, 1);
+    BLEMB_STATS_ADD(context->stats, bytes_emitted, packet_size);
+    return BLEMB_TRUE;
+}
+
+blemb_uint32_t _blemb_protow_mux_pick(blemb_protow_context_t * context) {
+    // Busy stream with the highest priority. The scan starts after the last stream served,
+    // so streams of equal priority take turns. Returns `stream_count` when all are idle.
+    blemb_uint32_t best = context->stream_count;
+    blemb_uint32_t index = context->stream_next < context->stream_count ? context->stream_next : 0;
+    
+    for (blemb_uint32_t i = 0; i < context->stream_count; i++) {
+        blemb_protow_stream_t * stream = &context->streams[index];
+        if (stream->busy == BLEMB_TRUE && (best == context->stream_count || stream->priority > context->streams[best].priority)) {
+            best = index;
         }
+        index = index + 1 < context->stream_count ? index + 1 : 0;
+    }
+    
+    return best;
+}
+
+blemb_bool_t _blemb_protow_mux_pump(blemb_protow_context_t * context) {
+    // Same rules as the queue: state is read back from the context after every callback.
+    blemb_uint32_t index;
+    while ((index = _blemb_protow_mux_pick(context)) < context->stream_count) {
+        blemb_protow_stream_t * stream = &context->streams[index];
+        blemb_byte_t stream_id = (blemb_byte_t)index;
+        if (_blemb_protow_queue_send(context, &stream->iterator, blemb_buffer_init(&stream_id, 1)) == BLEMB_FALSE) return BLEMB_FALSE;
+        
+        context->stream_next = index + 1;
+        if (_blemb_protow_iterator_peek(&stream->iterator) > 0) continue;
         
-        blemb_buffer_t packet_buffer = blemb_buffer_slice(message_buffer, offset, packet_size);
-        if (blemb_buffer_is_empty(packet_buffer) == BLEMB_FALSE) {
-            writer(packet_buffer);
+        stream->busy = BLEMB_FALSE;
+        BLEMB_STATS_ADD(context->stats, messages_written, 1);
+        if (context->on_complete != NULL) {
+            context->on_complete(context, stream->iterator.payload, stream->tag);
         }
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protow_pump(blemb_protow_context_t * context) {
+    if (context == NULL || context->try_writer == NULL) return BLEMB_FALSE;
+    
+    if (context->streams != NULL) return _blemb_protow_mux_pump(context);
+    if (context->queue == NULL) return BLEMB_FALSE;
+    
+    // State is read back from the context after every callback: `on_complete` may submit.
+    while (context->queue_count > 0) {
+        blemb_protow_queue_entry_t * entry = &context->queue[context->queue_head];
+        if (_blemb_protow_queue_send(context, &entry->iterator, blemb_buffer_init(NULL, 0)) == BLEMB_FALSE) return BLEMB_FALSE;
         
-        // This is guaranteed because `offset` is always less than `message_buffer.size` (enforced by the while loop),
-        // and `message_buffer.size` is at most `4 + payload_size`. Since `payload_size` has a maximum of UINT16_MAX,
-        // the maximum possible value for `offset` is `4 + UINT16_MAX`.
-        // Additionally, `packet_size` is always less than or equal to `mtu`, which is capped at 4096 (enforced by a pre-check).
-        // Therefore, the worst-case value for `offset + packet_size` is `4 + UINT16_MAX + 4096`, which safely fits in a 32-bit integer.
-        offset = offset + packet_size;
+        if (_blemb_protow_iterator_peek(&entry->iterator) > 0) continue;
+        
+        // Last packet accepted: release the entry before notifying.
+        blemb_buffer_t data = entry->iterator.payload;
+        void * tag = entry->tag;
+        context->queue_head = context->queue_head + 1 == context->queue_max_count ? 0 : context->queue_head + 1;
+        context->queue_count--;
+        
+        BLEMB_STATS_ADD(context->stats, messages_written, 1);
+        if (context->on_complete != NULL) {
+            context->on_complete(context, data, tag);
+        }
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protow_submit(blemb_protow_context_t * context, blemb_buffer_t data, void * tag) {
+    if (context == NULL || context->try_writer == NULL || context->queue == NULL) return BLEMB_FALSE;
+    if (context->streams != NULL) return BLEMB_FALSE;
+    if (context->queue_count >= context->queue_max_count) return BLEMB_FALSE;
+    
+    blemb_uint32_t index = context->queue_head + context->queue_count;
+    if (index >= context->queue_max_count) {
+        index -= context->queue_max_count;
     }
     
+    blemb_protow_queue_entry_t * entry = &context->queue[index];
+    if (_blemb_protow_iterator_init(&entry->iterator, context->magic, context->format, context->mtu, data, NULL) == BLEMB_FALSE) return BLEMB_FALSE;
+    entry->tag = tag;
+    context->queue_count++;
+    
+    blemb_protow_pump(context);
     return BLEMB_TRUE;
 }
 
+blemb_bool_t blemb_protow_stream_submit(blemb_protow_context_t * context, blemb_uint8_t stream_id, blemb_buffer_t data, void * tag) {
+    if (context == NULL || context->try_writer == NULL || context->streams == NULL) return BLEMB_FALSE;
+    if (stream_id >= context->stream_count || context->stream_count > 256) return BLEMB_FALSE;
+    
+    // One byte of every packet goes to the stream index.
+    if (context->mtu < 2) return BLEMB_FALSE;
+    
+    blemb_protow_stream_t * stream = &context->streams[stream_id];
+    if (stream->busy == BLEMB_TRUE) return BLEMB_FALSE;
+    if (_blemb_protow_iterator_init(&stream->iterator, context->magic, context->format, context->mtu - 1, data, NULL) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    stream->tag = tag;
+    stream->busy = BLEMB_TRUE;
+    
+    _blemb_protow_mux_pump(context);
+    return BLEMB_TRUE;
+}
+
+// --------
+// RELIABLE
+// --------
+// The message stays referenced until the receiver acknowledges it. Each fragment is a
+// fixed range of the message, so any of them is described again from the iterator
+// when a report asks for it. Nothing is copied ahead.
+blemb_size_t _blemb_protow_fragment_count(blemb_protow_iterator_t * iterator) {
+    // The iterator's `mtu` is the fragment size.
+    return (iterator->message_size + iterator->mtu - 1) / iterator->mtu;
+}
+
+blemb_size_t _blemb_protow_fragment_slice(blemb_protow_iterator_t * iterator, blemb_size_t index, blemb_buffer_t * head, blemb_buffer_t * body, blemb_buffer_t * tail) {
+    // Describes fragment `index` and returns its size.
+    // `index * mtu` will not overflow: there are at most `BLEMB_FRAME_FRAGMENT_MAX_COUNT`
+    // fragments and `mtu` is at most 4096.
+    iterator->offset = index * iterator->mtu;
+    blemb_size_t size = _blemb_protow_iterator_peek(iterator);
+    
+    _blemb_protow_iterator_slice(iterator, size, head, body, tail);
+    return size;
+}
+
+blemb_bool_t _blemb_protow_lanes_are_valid(blemb_protow_context_t * context) {
+    if (context->lanes == NULL) return context->writer != NULL ? BLEMB_TRUE : BLEMB_FALSE;
+    if (context->lane_count == 0) return BLEMB_FALSE;
+    
+    for (blemb_size_t i = 0; i < context->lane_count; i++) {
+        if (context->lanes[i].writer == NULL) return BLEMB_FALSE;
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_protow_writer_f _blemb_protow_next_lane(blemb_protow_context_t * context) {
+    // Smooth weighted round-robin: every lane earns its weight, the richest one sends and
+    // pays the total back. Weights 3 and 1 send A A B A rather than A A A B, so no lane
+    // sits idle for long.
+    if (context->lanes == NULL) return context->writer;
+    
+    blemb_int32_t total = 0;
+    blemb_protow_lane_t * chosen = NULL;
+    for (blemb_size_t i = 0; i < context->lane_count; i++) {
+        blemb_protow_lane_t * lane = &context->lanes[i];
+        blemb_int32_t weight = lane->weight > 0 ? lane->weight : 1;
+        
+        lane->credit += weight;
+        total += weight;
+        if (chosen == NULL || lane->credit > chosen->credit) chosen = lane;
+    }
+    
+    chosen->credit -= total;
+    return chosen->writer;
+}
+
+void _blemb_protow_send_packet(blemb_protow_context_t * context, blemb_byte_t * packet_data, blemb_size_t packet_size) {
+    // Fills in the checksum, the last byte of every fragment.
+    packet_data[packet_size - 1] = blemb_crc8_compute(blemb_buffer_init(packet_data, packet_size - 1));
+    
+    BLEMB_STATS_ADD(context->stats, packets_emitted, 1);
+    BLEMB_STATS_ADD(context->stats, bytes_emitted, packet_size);
+    _blemb_protow_next_lane(context)(blemb_buffer_init(packet_data, packet_size));
+}
+
+void _blemb_protow_send_fragment(blemb_protow_context_t * context, blemb_size_t index) {
+    blemb_protow_iterator_t * iterator = &context->reliable_entry.iterator;
+    
+    blemb_buffer_t head, body, tail;
+    blemb_size_t size = _blemb_protow_fragment_slice(iterator, index, &head, &body, &tail);
+    blemb_uint16_t flags = iterator->offset == iterator->message_size ? BLEMB_FRAME_FRAGMENT_LAST : 0;
+    
+    blemb_size_t packet_size = size + BLEMB_FRAME_FRAGMENT_OVERHEAD;
+    blemb_byte_t packet_data[packet_size];
+    blemb_frame_write_fragment_header(context->reliable_sequence, (blemb_uint16_t)index, flags, packet_data);
+    _blemb_protow_gather(packet_data + BLEMB_FRAME_FRAGMENT_HEADER_SIZE, head, body, tail);
+    
+    _blemb_protow_send_packet(context, packet_data, packet_size);
+}
+
+void _blemb_protow_send_parity(blemb_protow_context_t * context, blemb_size_t group, blemb_size_t row) {
+    // Parity is computed straight from the payload, one fragment at a time: the short
+    // last fragment counts as zero-padded.
+    blemb_protow_iterator_t * iterator = &context->reliable_entry.iterator;
+    blemb_size_t fragment_count = _blemb_protow_fragment_count(iterator);
+    
+    blemb_size_t packet_size = iterator->mtu + BLEMB_FRAME_PARITY_OVERHEAD;
+    blemb_byte_t packet_data[packet_size];
+    blemb_byte_t * parity = packet_data + BLEMB_FRAME_PARITY_HEADER_SIZE;
+    memset(parity, 0, iterator->mtu);
+    
+    blemb_size_t first = group * context->fec_data_count;
+    blemb_size_t data_count = fragment_count - first < context->fec_data_count ? fragment_count - first : context->fec_data_count;
+    for (blemb_size_t index = first; index < first + data_count; index++) {
+        blemb_byte_t coefficient = blemb_frame_parity_coefficient(context->fec_data_count, row, index - first);
+        
+        blemb_buffer_t head, body, tail;
+        _blemb_protow_fragment_slice(iterator, index, &head, &body, &tail);
+        blemb_gf256_mul_add(parity, head.data, coefficient, head.size);
+        blemb_gf256_mul_add(parity + head.size, body.data, coefficient, body.size);
+        blemb_gf256_mul_add(parity + head.size + body.size, tail.data, coefficient, tail.size);
+    }
+    
+    blemb_uint16_t index = (blemb_uint16_t)(group * context->fec_parity_count + row);
+    blemb_frame_write_parity_header(context->reliable_sequence, index, (blemb_uint8_t)data_count, packet_data);
+    
+    BLEMB_STATS_ADD(context->stats, parity_emitted, 1);
+    _blemb_protow_send_packet(context, packet_data, packet_size);
+}
+
+blemb_bool_t _blemb_protow_fec_is_valid(blemb_protow_context_t * context, blemb_size_t fragment_count) {
+    if (context->fec_parity_count == 0) return BLEMB_TRUE;
+    
+    if (context->fec_data_count == 0 || context->fec_parity_count > BLEMB_FRAME_FEC_MAX_PARITY_COUNT) return BLEMB_FALSE;
+    if (context->fec_data_count + BLEMB_FRAME_FEC_MAX_PARITY_COUNT > 256) return BLEMB_FALSE;
+    
+    // Parity indexes must fit, too.
+    blemb_size_t group_count = (fragment_count + context->fec_data_count - 1) / context->fec_data_count;
+    return group_count * context->fec_parity_count <= BLEMB_FRAME_FRAGMENT_MAX_COUNT ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+void _blemb_protow_send_message(blemb_protow_context_t * context) {
+    blemb_size_t fragment_count = _blemb_protow_fragment_count(&context->reliable_entry.iterator);
+    for (blemb_size_t index = 0; index < fragment_count; index++) {
+        _blemb_protow_send_fragment(context, index);
+        
+        // Parity goes out as soon as its group is complete.
+        if (context->fec_parity_count == 0) continue;
+        if ((index + 1) % context->fec_data_count != 0 && index + 1 != fragment_count) continue;
+        
+        for (blemb_size_t row = 0; row < context->fec_parity_count; row++) {
+            _blemb_protow_send_parity(context, index / context->fec_data_count, row);
+        }
+    }
+}
+
+blemb_bool_t blemb_protow_write_reliable(blemb_protow_context_t * context, blemb_buffer_t data, void * tag) {
+    if (context == NULL || _blemb_protow_lanes_are_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (context->reliable_pending == BLEMB_TRUE) return BLEMB_FALSE;
+    
+    // Every packet needs room for the fragment (or parity) header, the checksum and one
+    // message byte. Fragments are as big as the parity bytes.
+    blemb_size_t overhead = context->fec_parity_count > 0 ? BLEMB_FRAME_PARITY_OVERHEAD : BLEMB_FRAME_FRAGMENT_OVERHEAD;
+    if (context->mtu <= overhead) return BLEMB_FALSE;
+    
+    blemb_protow_iterator_t * iterator = &context->reliable_entry.iterator;
+    blemb_uint16_t fragment_size = (blemb_uint16_t)(context->mtu - overhead);
+    if (_blemb_protow_iterator_init(iterator, context->magic, context->format, fragment_size, data, NULL) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    blemb_size_t fragment_count = _blemb_protow_fragment_count(iterator);
+    if (fragment_count > BLEMB_FRAME_FRAGMENT_MAX_COUNT) return BLEMB_FALSE;
+    if (_blemb_protow_fec_is_valid(context, fragment_count) == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    context->reliable_entry.tag = tag;
+    context->reliable_pending = BLEMB_TRUE;
+    
+    _blemb_protow_send_message(context);
+    
+    BLEMB_STATS_ADD(context->stats, messages_written, 1);
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protow_resend_reliable(blemb_protow_context_t * context) {
+    if (context == NULL || _blemb_protow_lanes_are_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (context->reliable_pending == BLEMB_FALSE) return BLEMB_FALSE;
+    
+    BLEMB_STATS_ADD(context->stats, fragments_resent, _blemb_protow_fragment_count(&context->reliable_entry.iterator));
+    _blemb_protow_send_message(context);
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protow_handle_report(blemb_protow_context_t * context, blemb_buffer_t report) {
+    if (context == NULL || _blemb_protow_lanes_are_valid(context) == BLEMB_FALSE) return BLEMB_FALSE;
+    if (report.data == NULL || report.size < 1 || (report.size - 1) % 2 != 0) return BLEMB_FALSE;
+    
+    // A report about the previous message comes from a receiver that has not seen any
+    // fragment of the pending one and still acknowledges the previous message: everything
+    // is sent again. Other reports are stale.
+    if (context->reliable_pending == BLEMB_FALSE) return BLEMB_TRUE;
+    if (report.data[0] == (blemb_uint8_t)(context->reliable_sequence - 1)) return blemb_protow_resend_reliable(context);
+    if (report.data[0] != context->reliable_sequence) return BLEMB_TRUE;
+    
+    blemb_protow_iterator_t * iterator = &context->reliable_entry.iterator;
+    if (report.size == 1) {
+        // Acknowledged: the next message gets a new sequence.
+        context->reliable_pending = BLEMB_FALSE;
+        context->reliable_sequence++;
+        
+        if (context->on_complete != NULL) {
+            context->on_complete(context, iterator->payload, context->reliable_entry.tag);
+        }
+        return BLEMB_TRUE;
+    }
+    
+    blemb_size_t fragment_count = _blemb_protow_fragment_count(iterator);
+    for (blemb_offset_t offset = 1; offset < report.size; offset += 2) {
+        blemb_uint16_t entry = (blemb_uint16_t)(((blemb_uint16_t)report.data[offset] << 8) | report.data[offset + 1]);
+        blemb_size_t index = entry & ~BLEMB_FRAME_REPORT_FROM;
+        blemb_size_t end = (entry & BLEMB_FRAME_REPORT_FROM) != 0 ? fragment_count : index + 1;
+        
+        for (; index < end && index < fragment_count; index++) {
+            BLEMB_STATS_ADD(context->stats, fragments_resent, 1);
+            _blemb_protow_send_fragment(context, index);
+        }
+    }
+    
+    return BLEMB_TRUE;
+}
+
+// -----------
+// COMPRESSION
+// -----------
+blemb_buffer_t _blemb_protow_compress(blemb_protow_context_t * context, blemb_buffer_t data, blemb_byte_t * encoding) {
+    // Returns what goes out: the payload compressed into `compress_data` when that makes
+    // it smaller, the payload itself otherwise.
+    *encoding = BLEMB_FRAME_ENCODING_RAW;
+    if (blemb_frame_encoding_size(context->format) == 0 || context->compress_data == NULL) return data;
+    if (data.data == NULL || data.size < 2) return data;
+    
+    blemb_size_t capacity = data.size - 1;
+    if (capacity > context->compress_max_size) capacity = context->compress_max_size;
+    
+    blemb_size_t size = 0;
+    if (blemb_lz_compress(context->compression_dictionary, data, blemb_buffer_init(context->compress_data, capacity), &size) == BLEMB_FALSE) return data;
+    
+    BLEMB_STATS_ADD(context->stats, compression_saved_bytes, data.size - size);
+    *encoding = BLEMB_FRAME_ENCODING_LZ;
+    return blemb_buffer_init(context->compress_data, size);
+}
+
 blemb_bool_t blemb_protow_write(blemb_protow_context_t * context, blemb_buffer_t data) {
     if (context == NULL) return BLEMB_FALSE;
     
-    return _blemb_protow_write_message(context->magic, context->mtu, data, context->writer);
+    // On a multiplexed link every packet must carry a stream index.
+    if (context->streams != NULL) return BLEMB_FALSE;
+    
+    blemb_byte_t encoding;
+    data = _blemb_protow_compress(context, data, &encoding);
+    
+    if (context->batch_data != NULL) {
+        return _blemb_protow_write_batched(context, data, encoding);
+    }
+    
+    return _blemb_protow_write_message(context->magic, context->format, context->mtu, data, encoding, context->writer, context->gather_writer, context->stats);
+}
+
+blemb_bool_t blemb_protow_flush(blemb_protow_context_t * context) {
+    if (context == NULL) return BLEMB_FALSE;
+    if (context->writer == NULL && context->gather_writer == NULL) return BLEMB_FALSE;
+    
+    if (context->batch_data != NULL) {
+        _blemb_protow_batch_emit(context);
+    }
+    
+    return BLEMB_TRUE;
+}
+
+blemb_bool_t blemb_protow_begin(blemb_protow_context_t * context, blemb_protow_iterator_t * iterator, blemb_buffer_t data) {
+    if (context == NULL || iterator == NULL) return BLEMB_FALSE;
+    
+    return _blemb_protow_iterator_init(iterator, context->magic, context->format, context->mtu, data, context->stats);
+}
+
+blemb_bool_t blemb_protow_has_next(blemb_protow_iterator_t * iterator) {
+    if (iterator == NULL) return BLEMB_FALSE;
+    
+    return _blemb_protow_iterator_peek(iterator) > 0 ? BLEMB_TRUE : BLEMB_FALSE;
+}
+
+blemb_bool_t blemb_protow_next(blemb_protow_iterator_t * iterator, blemb_buffer_t packet, blemb_size_t * packet_size) {
+    if (packet_size != NULL) *packet_size = 0;
+    if (iterator == NULL) return BLEMB_FALSE;
+    
+    // The iterator only moves once the packet has been copied out.
+    blemb_size_t size = _blemb_protow_iterator_peek(iterator);
+    if (size == 0) return BLEMB_FALSE;
+    if (packet.data == NULL || packet.size < size) return BLEMB_FALSE;
+    
+    blemb_buffer_t head, body, tail;
+    _blemb_protow_iterator_advance(iterator, &head, &body, &tail);
+    _blemb_protow_gather(packet.data, head, body, tail);
+    
+    if (packet_size != NULL) *packet_size = size;
+    return BLEMB_TRUE;
+}
+
+void blemb_protow_stats_snapshot(blemb_protow_context_t * context, blemb_protow_stats_t * snapshot) {
+    if (snapshot == NULL) return;
+    
+    if (context == NULL || context->stats == NULL) {
+        memset(snapshot, 0, sizeof(*snapshot));
+        return;
+    }
+    
+    *snapshot = *context->stats;
+}
+
+void blemb_protow_stats_reset(blemb_protow_context_t * context) {
+    if (context == NULL || context->stats == NULL) return;
+    
+    memset(context->stats, 0, sizeof(*context->stats));
 }
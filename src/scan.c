@@ -0,0 +1,162 @@
+//
+//  scan.c
+//  BLEMB
+//
+//  Created by Diego Fernandez on 17/10/26.
+//
+
+// STDLIB
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// PUBLIC
+#include <blemb/types.h>
+#include <blemb/buffer.h>
+
+// PRIVATE
+#include <blemb_scan.h>
+
+// -----
+// BLOCK
+// -----
+// Every kernel compares a block of bytes against `value` and returns a mask with
+// bit `i` set when byte `i` of the block matches.
+#if defined(__AVX2__)
+#define _BLEMB_SCAN_BLOCK_SIZE 32
+typedef blemb_uint32_t _blemb_scan_mask_t;
+
+static inline _blemb_scan_mask_t _blemb_scan_block(const blemb_byte_t * data, blemb_byte_t value) {
+    __m256i needle = _mm256_set1_epi8((char)value);
+    __m256i block = _mm256_loadu_si256((const __m256i *)data);
+    
+    return (_blemb_scan_mask_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+}
+#elif defined(__SSE2__)
+#define _BLEMB_SCAN_BLOCK_SIZE 16
+typedef blemb_uint32_t _blemb_scan_mask_t;
+
+static inline _blemb_scan_mask_t _blemb_scan_block(const blemb_byte_t * data, blemb_byte_t value) {
+    __m128i needle = _mm_set1_epi8((char)value);
+    __m128i block = _mm_loadu_si128((const __m128i *)data);
+    
+    return (_blemb_scan_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+}
+#elif defined(__ARM_NEON)
+#define _BLEMB_SCAN_BLOCK_SIZE 16
+typedef uint64_t _blemb_scan_mask_t;
+
+static inline _blemb_scan_mask_t _blemb_scan_block(const blemb_byte_t * data, blemb_byte_t value) {
+    uint8x16_t matches = vceqq_u8(vld1q_u8(data), vdupq_n_u8(value));
+    
+    // NEON has no movemask: narrowing by 4 bits leaves one nibble per byte,
+    // which is then compacted to one bit per byte.
+    uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    if (nibbles == 0) return 0;
+    
+    _blemb_scan_mask_t mask = 0;
+    for (blemb_uint32_t i = 0; i < 16; i++) {
+        mask |= ((nibbles >> (i * 4)) & 1) << i;
+    }
+    return mask;
+}
+#else
+#define _BLEMB_SCAN_BLOCK_SIZE 8
+typedef blemb_uint32_t _blemb_scan_mask_t;
+
+static inline _blemb_scan_mask_t _blemb_scan_block(const blemb_byte_t * data, blemb_byte_t value) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    
+    // SWAR: a byte of `word ^ pattern` is zero where `data` matches. The test is
+    // exact (no borrow propagation between bytes), so only words that really
+    // contain a match are inspected byte by byte.
+    uint64_t x = word ^ (0x0101010101010101ULL * value);
+    uint64_t zero = ~(((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x) & 0x8080808080808080ULL;
+    if (zero == 0) return 0;
+    
+    _blemb_scan_mask_t mask = 0;
+    for (blemb_uint32_t i = 0; i < 8; i++) {
+        if (data[i] == value) mask |= (_blemb_scan_mask_t)1 << i;
+    }
+    return mask;
+}
+#endif
+
+static inline blemb_uint32_t _blemb_scan_lowest_bit(_blemb_scan_mask_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return sizeof(mask) > 4 ? (blemb_uint32_t)__builtin_ctzll(mask) : (blemb_uint32_t)__builtin_ctz((blemb_uint32_t)mask);
+#else
+    blemb_uint32_t index = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// ------
+// PUBLIC
+// ------
+blemb_offset_t blemb_scan_find_byte(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value) {
+    if (buffer.data == NULL) return buffer.size;
+    
+    // `buffer.size - offset` will not underflow, the loop conditions ensure `offset` is lower.
+    while (offset < buffer.size && buffer.size - offset >= _BLEMB_SCAN_BLOCK_SIZE) {
+        _blemb_scan_mask_t mask = _blemb_scan_block(buffer.data + offset, value);
+        if (mask != 0) {
+            return offset + _blemb_scan_lowest_bit(mask);
+        }
+        offset += _BLEMB_SCAN_BLOCK_SIZE;
+    }
+    
+    for (; offset < buffer.size; offset++) {
+        if (buffer.data[offset] == value) {
+            return offset;
+        }
+    }
+    
+    return buffer.size;
+}
+
+blemb_size_t blemb_scan_find_all(blemb_buffer_t buffer, blemb_offset_t offset, blemb_byte_t value, blemb_offset_t * result, blemb_size_t max_count, blemb_offset_t * next_offset) {
+    blemb_size_t count = 0;
+    
+    if (buffer.data == NULL || result == NULL || max_count == 0) {
+        if (next_offset != NULL) *next_offset = offset < buffer.size ? offset : buffer.size;
+        return 0;
+    }
+    
+    while (offset < buffer.size && buffer.size - offset >= _BLEMB_SCAN_BLOCK_SIZE) {
+        _blemb_scan_mask_t mask = _blemb_scan_block(buffer.data + offset, value);
+        while (mask != 0) {
+            blemb_offset_t match = offset + _blemb_scan_lowest_bit(mask);
+            if (count == max_count) {
+                if (next_offset != NULL) *next_offset = match;
+                return count;
+            }
+            result[count++] = match;
+            mask &= mask - 1;
+        }
+        offset += _BLEMB_SCAN_BLOCK_SIZE;
+    }
+    
+    for (; offset < buffer.size; offset++) {
+        if (buffer.data[offset] != value) continue;
+        
+        if (count == max_count) {
+            if (next_offset != NULL) *next_offset = offset;
+            return count;
+        }
+        result[count++] = offset;
+    }
+    
+    if (next_offset != NULL) *next_offset = buffer.size;
+    return count;
+}